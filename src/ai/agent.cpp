@@ -13,6 +13,7 @@
 #include "includes/evaluation.hpp"
 #include "includes/hyperparameters.hpp"
 #include "includes/search_algorithms.hpp"
+#include "includes/parallel_search.hpp"
 
 Agent::Agent(std::string id) : id(std::move(id)) {}
 
@@ -130,8 +131,13 @@ void HyperparametersAgent::initialize(long long milliseconds, bool isBlack) {
         searchAlgorithm = new Minimax(hyperparameters, *evaluation);
     else if(hyperparameters.get<int>(SEARCH_ALGORITHM_ID) == USE_ITERATIVE_MINIMAX)
         searchAlgorithm = new IterativeMinimax(hyperparameters, *evaluation);
+    else if(hyperparameters.get<int>(SEARCH_ALGORITHM_ID) == USE_PARALLEL_MINIMAX)
+        searchAlgorithm = new ParallelMinimax(hyperparameters, *evaluation);
+    else if(hyperparameters.get<int>(SEARCH_ALGORITHM_ID) == USE_MTDF_MINIMAX)
+        searchAlgorithm = new MtdfMinimax(hyperparameters, *evaluation);
     else
         searchAlgorithm = new RandomSearch();
+    searchAlgorithm->setStopSignal(stopSignal);
 }
 
 HyperparametersAgent::HyperparametersAgent(const std::filesystem::path &hyperparametersPath, std::string id): Agent(std::move(id)), hyperparameters(hyperparametersPath){}
@@ -147,6 +153,22 @@ std::pair<int, piece_move> HyperparametersAgent::findBestMove(Game &game, const
     return bestMove;
 }
 
+void HyperparametersAgent::setStopSignal(const std::atomic<bool> *signal) {
+    stopSignal = signal;
+    if(searchAlgorithm)
+        searchAlgorithm->setStopSignal(signal);
+}
+
+piece_move HyperparametersAgent::getExpectedMove(Game &game) {
+    if(!searchAlgorithm || !hyperparameters.get<bool>(PONDER_ID))
+        return 0;
+    return searchAlgorithm->getExpectedMove(game);
+}
+
+bool HyperparametersAgent::logsPondering() {
+    return hyperparameters.get<bool>(LOG_PONDERING_ID);
+}
+
 ExecutableAgent::ExecutableAgent(const std::filesystem::path &executablePath, std::string id)
         : Agent(std::move(id)), executablePath(executablePath) {
     if (!std::filesystem::exists(executablePath)) {
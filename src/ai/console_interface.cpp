@@ -1,7 +1,61 @@
+#include <format>
+
 #include "includes/console_interface.hpp"
 
 ConsoleInterface::ConsoleInterface(Agent *agent) : agent(agent) {}
 
+/**
+ * @brief Searches the position after the expected reply of the opponent on a background thread.
+ *
+ * The expected reply is the best move of the position stored by the agent (the principal variation of the last search).
+ * Pondering is skipped if the agent does not expect any reply or the game ends.
+ * @param game The game after our move.
+ * @param remainingTime Our remaining time in milliseconds (the search budgets its time from it, starting now).
+ */
+void ConsoleInterface::startPondering(const Game &game, long long remainingTime)
+{
+    if(game.isFinished())
+        return;
+    Game ponderGame = game;
+    piece_move expectedMove = agent->getExpectedMove(ponderGame);
+    if(expectedMove == 0)
+        return;
+    ponderGame.makeMove(expectedMove);
+    if(ponderGame.isFinished())
+        return;
+
+    ponderBoard.emplace(ponderGame.getBoard());
+    ponderThread = std::thread([this, ponderGame, remainingTime]() mutable {
+        Timer ponderTimer(remainingTime); // Paused, the time budget of the search is kept by the agent itself
+        ponderResult = agent->findBestMove(ponderGame, ponderTimer);
+    });
+}
+
+/**
+ * @brief Ends the pondering once the opponent's move is known.
+ *
+ * On a ponder hit the search goes on until it uses up its time budget (counted from the start of pondering).
+ * On a miss the search is stopped, the cache keeps what it found.
+ * @param board The board after the opponent's move.
+ * @return Whether the pondered position was reached (ponderResult holds our move then).
+ */
+bool ConsoleInterface::stopPondering(const Board &board)
+{
+    if(!ponderThread.joinable())
+        return false;
+    const bool hit = board == ponderBoard;
+    if(!hit)
+        ponderStopSignal = true;
+    ponderThread.join();
+    ponderStopSignal = false;
+
+    ponders++;
+    ponderHits += hit;
+    if(agent->logsPondering())
+        std::cerr << std::format("ponder: {}, hit rate {}/{} ({:.1f}%)\n", hit ? "hit" : "miss", ponderHits, ponders, 100.0 * ponderHits / ponders);
+    return hit;
+}
+
 void ConsoleInterface::run(){
     long long timeLimit; // in milliseconds
     std::cin>>timeLimit;
@@ -10,11 +64,13 @@ void ConsoleInterface::run(){
     bool isBlack = color == "black";
 
     agent->initialize(timeLimit, isBlack);
+    agent->setStopSignal(&ponderStopSignal);
 
     while(true)
     {
         int timeLeft; // in milliseconds
-        std::cin>>timeLeft;
+        if(!(std::cin>>timeLeft)) // The input was closed, the game is over
+            break;
 
         std::vector<std::string> boardState(8);
         for(unsigned int i = 0; i < 8; i++) {
@@ -43,7 +99,11 @@ void ConsoleInterface::run(){
 
         Timer timer(timeLeft);
         timer.resume();
-        std::pair<int, piece_move> bestMove = agent->findBestMove(game, timer);
+        std::pair<int, piece_move> bestMove;
+        if(stopPondering(board))
+            bestMove = ponderResult;
+        else
+            bestMove = agent->findBestMove(game, timer);
         game.makeMove(bestMove.second);
 
         Move madeMove = gameState.getMove(bestMove.second);
@@ -55,10 +115,14 @@ void ConsoleInterface::run(){
         }
         std::cout<<std::endl;
 
+        startPondering(game, timer.getRemainingTime());
+
        // std::cout<<simulateGame.getGameState().board;
     }
-}
-
-
-
 
+    if(ponderThread.joinable())
+    {
+        ponderStopSignal = true;
+        ponderThread.join();
+    }
+}
@@ -12,8 +12,8 @@ BasicEvaluation::BasicEvaluation(Hyperparameters &hyperparameters)
 int BasicEvaluation::evaluate(const GameState& gameState)
 {
     const Board& board = gameState.board;
-    if(gameState.getAvailableMoves().empty())
-        return INT32_MIN;
+    if(!gameState.hasAnyMove())
+        return LOSS_SCORE;
     int score = (board.blackPawnsCount() - board.whitePawnsCount()) * pawnValue + (board.blackKingsCount() - board.whiteKingsCount()) * kingValue;
     return score * (gameState.nextBlack ? 1 : -1);
 }
@@ -29,8 +29,8 @@ AdvancedEvaluation::AdvancedEvaluation(Hyperparameters &hyperparameters)
 
 int AdvancedEvaluation::evaluate(const GameState &gameState)
 {
-    if (gameState.getAvailableMoves().empty())
-        return INT32_MIN;
+    if (!gameState.hasAnyMove())
+        return LOSS_SCORE;
 
     int pawnTableScore = 0;
     int kingTableScore = 0;
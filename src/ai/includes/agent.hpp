@@ -48,6 +48,9 @@ public:
     void die(); ///< Kills the agent's subprocess
     virtual void initialize(long long timeLimit, bool isBlack); ///< Initializes the agent (a new game is starting)
     virtual std::pair<int, piece_move> findBestMove(Game &game, const Timer &timer); ///< Returns a chosen move for the given game state
+    virtual void setStopSignal(const std::atomic<bool> *) {} ///< Sets a flag which ends the searches of the agent early when set (nullptr for none)
+    virtual piece_move getExpectedMove(Game &) { return 0; } ///< Returns the move the agent expects to be played in the position (0 if none, disables pondering)
+    virtual bool logsPondering() { return false; } ///< Returns whether the console interface prints the ponder hit rate
 
     virtual ~Agent();
     Agent(const Agent&) = delete;
@@ -63,12 +66,14 @@ public:
  * @var hyperparameters The hyperparameters of the agent
  * @var evaluation The evaluation algorithm used by the agent
  * @var searchAlgorithm The search algorithm used by the agent
+ * @var stopSignal The flag which ends the searches of the agent early when set (optional)
  */
 class HyperparametersAgent: public Agent {
 private:
     Hyperparameters hyperparameters;
     Evaluation *evaluation;
-    SearchAlgorithm *searchAlgorithm;
+    SearchAlgorithm *searchAlgorithm = nullptr;
+    const std::atomic<bool> *stopSignal = nullptr;
     void initialize(long long timeLimit, bool isBlack) override;
     void runInBackground() override;
 
@@ -76,6 +81,9 @@ public:
     HyperparametersAgent(Hyperparameters &&hyperparameters, std::string id);
     HyperparametersAgent(const std::filesystem::path &hyperparametersPath, std::string id);
     std::pair<int, piece_move> findBestMove(Game &game, const Timer &timer) override;
+    void setStopSignal(const std::atomic<bool> *signal) override;
+    piece_move getExpectedMove(Game &game) override;
+    bool logsPondering() override;
 };
 
 // Contains executable path through which moves are received by specified protocol (described in user documentation)
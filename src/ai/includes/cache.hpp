@@ -1,111 +1,142 @@
 #ifndef CACHE_HPP
 #define CACHE_HPP
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include "../../communication/includes/game.hpp"
+#include "../../communication/includes/board_key.hpp"
 
 constexpr uint16_t UNSET_DEPTH = 0;
 
+/**
+ * @brief Clamps a score or a search bound to the range stored in the cache
+ *
+ * Bounds outside of the range of int32 (e.g. the negated INT32_MIN) cannot be exceeded by any score, so clamping them keeps their meaning.
+ */
+inline int32_t clampScore(long long score){
+    return static_cast<int32_t>(std::clamp<long long>(score, INT32_MIN, INT32_MAX));
+}
+
 /**
  * @struct CacheEntry
- * @brief Represents an entry in the cache.
+ * @brief Represents an entry in the cache (stored packed into 32 bytes).
  *
- * @var board The board ID used as the key (verification)
- * @var bestMove The best move
+ * @var key The compact board and side to move (verification)
  * @var score The score of the board
- * @var depth The depth of the search
  * @var upperBound The upper bound of the score
  * @var lowerBound The lower bound of the score
+ * @var bestMove The best move (moves longer than 32 bits are not stored)
+ * @var depth The depth of the search
  */
 struct CacheEntry {
-    board_id board;
-	piece_move bestMove=0;
-    long long score{};
-	uint16_t depth = UNSET_DEPTH;
-    long long upperBound = INT32_MIN;
-    long long lowerBound = INT32_MAX;
+    BoardKey key;
+    int32_t score{};
+    int32_t upperBound = INT32_MIN;
+    int32_t lowerBound = INT32_MAX;
+    uint32_t bestMove = 0;
+    uint16_t depth = UNSET_DEPTH;
 };
 
-
 /**
  * @class Cache
  * @brief Manages a cache for storing best moves and scores.
  *
- * A cache that stores the best moves and scores for a given board state. The cache is implemented as a hash table with buckets.
+ * A cache that stores the best moves and scores for a given board state. The cache is implemented as a hash table with buckets,
+ * the bucket is selected by the Zobrist hash maintained by the game (so no hash is computed per access).
  * It also attempts to be work efficiently with alpha beta pruning.
  *
+ * The cache can be shared by multiple search threads without locking: both words of the key are stored xor-ed with both data words,
+ * so an entry torn by concurrent writes fails the key check instead of returning a wrong score.
+ *
  * @tparam table_size The size of the cache
  * @tparam bucket_size The size of each bucket
  */
-template<size_t table_size=4194304, size_t bucket_size=3> // table size must be a power of 2!
+template<size_t table_size=8388608, size_t bucket_size=3> // table size must be a power of 2!
 class Cache {
 private:
-    inline uint64_t rotate_right(uint64_t x, int r) const{
-        return (x >> r) | (x << (64 - r));
-    }
-    inline uint64_t getHash(const Board board) const {
-        const uint64_t c1 = 0xff51afd7ed558ccd;
-        const uint64_t c2 = 0xc4ceb9fe1a85ec53;
-        uint64_t k2 = board.whiteBitboard;
-        uint64_t k1 = board.blackBitboard;
+    struct PackedEntry {
+        std::atomic<uint64_t> check0{0}; ///< Occupied squares and colors xor data0 xor data1
+        std::atomic<uint64_t> check1{0}; ///< Kings and depth xor data0 xor data1
+        std::atomic<uint64_t> data0{0}; ///< Score and upper bound
+        std::atomic<uint64_t> data1{0}; ///< Lower bound and best move
+    };
+
+    std::atomic<size_t> filled = 0;
 
-        k1 *= c1; k1 = rotate_right(k1, 31); k1 *= c2;
-        k2 *= c2; k2 = rotate_right(k2, 33); k2 *= c1;
+    static uint64_t joinWords(uint32_t low, uint32_t high) { return low | (static_cast<uint64_t>(high) << 32); }
 
-        return k1 ^ k2;
+    static void store(PackedEntry &packed, const CacheEntry &entry) {
+        const uint64_t data0 = joinWords(entry.score, entry.upperBound);
+        const uint64_t data1 = joinWords(entry.lowerBound, entry.bestMove);
+        packed.check0.store(joinWords(entry.key.occupied, entry.key.black) ^ data0 ^ data1, std::memory_order_relaxed);
+        packed.check1.store(joinWords(entry.key.kings, entry.depth) ^ data0 ^ data1, std::memory_order_relaxed);
+        packed.data0.store(data0, std::memory_order_relaxed);
+        packed.data1.store(data1, std::memory_order_relaxed);
+    }
+
+    static CacheEntry load(const PackedEntry &packed) {
+        const uint64_t data0 = packed.data0.load(std::memory_order_relaxed);
+        const uint64_t data1 = packed.data1.load(std::memory_order_relaxed);
+        const uint64_t key0 = packed.check0.load(std::memory_order_relaxed) ^ data0 ^ data1;
+        const uint64_t key1 = packed.check1.load(std::memory_order_relaxed) ^ data0 ^ data1;
+        return {{static_cast<bitboard>(key0), static_cast<uint32_t>(key0 >> 32), static_cast<uint32_t>(key1)},
+                static_cast<int32_t>(data0), static_cast<int32_t>(data0 >> 32), static_cast<int32_t>(data1),
+                static_cast<uint32_t>(data1 >> 32), static_cast<uint16_t>(key1 >> 32)};
     }
-    int filled = 0;
 public:
     /**
      * @brief Attempts to save the best move and score for a given board state
-     * @param gameState The game state
+     * @param game The game in the position to save
      * @param depth The depth of the search
      * @param score The found score for the board
      * @param upperBound The upper bound of the score
      * @param lowerBound The lower bound of the score
      * @param best The found best move
      */
-    inline void set(const GameState &gameState, uint16_t depth, long long score, long long upperBound, long long lowerBound, piece_move best) {
-        Board perspectiveBoard = gameState.getPerspectiveBoard(); // Get the board from the perspective of the current player optimal moves should be the same for both sides with correct evaluation
-        board_id boardID = perspectiveBoard.getID();
-        uint64_t hash = getHash(perspectiveBoard);
+    inline void set(const Game &game, uint16_t depth, long long score, long long upperBound, long long lowerBound, piece_move best) {
+        if(best > UINT32_MAX) // Extremely long capture sequence, not worth a wider entry
+            return;
+        // The key is the absolute board and the side to move (reversing the board to the player's perspective would cost two bit reversals per access)
+        BoardKey key = BoardKey::fromBoard(game.getBoard(), game.isNextBlack());
+        const CacheEntry entry{key, clampScore(score), clampScore(upperBound), clampScore(lowerBound), static_cast<uint32_t>(best), depth};
+        zobrist_key hash = game.getHash();
 		size_t idx = bucket_size * (hash & (table_size-1)); // Hash % table_size only for power of 2
+        std::array<CacheEntry, bucket_size> bucket;
         for(int i = 0; i < bucket_size; i++){
+            bucket[i] = load(table[idx + i]);
             // If the board is already in the cache and the new score is found for wider alpha beta window, update the entry
-            if(table[idx + i].board == boardID && table[idx + i].depth <= depth && table[idx + i].upperBound <= upperBound && table[idx + i].lowerBound >= lowerBound){
-                table[idx + i] = {boardID, best, score, depth, upperBound, lowerBound};
+            if(bucket[i].key == key && bucket[i].depth <= depth && bucket[i].upperBound <= entry.upperBound && bucket[i].lowerBound >= entry.lowerBound){
+                store(table[idx + i], entry);
                 return;
             }
         }
 
         for(int i = 0; i < bucket_size; i++){
             // If the bucket is empty or the depth is lower than the current entry, fill the bucket
-            if(table[idx + i].depth < depth){
-                if(table[idx + i].depth == UNSET_DEPTH) // Count the number of filled entries
-                    filled++;
-                table[idx + i] = {boardID, best, score, depth, upperBound, lowerBound};
+            if(bucket[i].depth < depth){
+                if(bucket[i].depth == UNSET_DEPTH) // Count the number of filled entries
+                    filled.fetch_add(1, std::memory_order_relaxed);
+                store(table[idx + i], entry);
                 return;
             }
         }
 	}
-    inline const CacheEntry &get(const GameState &gameState) const {
-        Board perspectiveBoard = gameState.getPerspectiveBoard();
-        uint64_t hash = getHash(perspectiveBoard);
-		size_t idx = 3 * (hash & (table_size-1));
+    inline CacheEntry get(const Game &game) const {
+        BoardKey key = BoardKey::fromBoard(game.getBoard(), game.isNextBlack());
+		size_t idx = bucket_size * (game.getHash() & (table_size-1));
         for(int i = 0; i < bucket_size; i++){
-            if(table[idx + i].board == perspectiveBoard.getID()){
-                return table[idx + i];
+            CacheEntry entry = load(table[idx + i]);
+            if(entry.key == key){
+                return entry;
             }
         }
-        return null_entry;
+        return {};
 	}
-	inline float fillRate() const { return static_cast<float>(filled) / static_cast<float>(table_size * 3); }
+	inline float fillRate() const { return static_cast<float>(filled.load()) / static_cast<float>(table_size * bucket_size); }
 private:
-	std::array<CacheEntry, bucket_size * table_size> table{};
-	CacheEntry null_entry;
-#ifdef MEASURE_CACHE_FILL
-	size_t filled = 0;
-#endif
+    static_assert(sizeof(PackedEntry) == 32);
+	std::array<PackedEntry, bucket_size * table_size> table{};
 };
 
 #endif
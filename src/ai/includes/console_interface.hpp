@@ -1,7 +1,10 @@
 #ifndef CONSOLE_INTERFACE_HPP
 #define CONSOLE_INTERFACE_HPP
 
+#include <atomic>
 #include <iostream>
+#include <optional>
+#include <thread>
 
 #include "../../communication/includes/game.hpp"
 #include "agent.hpp"
@@ -12,15 +15,32 @@
  *
  * Allows for converting an agent into an executable.
  * Builds an executable agent behaving according to the specified protocol.
+ * While the opponent thinks, the agent ponders: it searches the position after the reply it expects,
+ * on a ponder hit the search continues, on a miss it is stopped (the cache is kept).
  *
  * @var agent The agent to be converted
+ * @var ponderThread The thread searching the pondered position (not joinable if not pondering)
+ * @var ponderStopSignal Stops the pondering search on a ponder miss
+ * @var ponderBoard The board of the pondered position
+ * @var ponderResult The move found by the pondering search
+ * @var ponders The number of pondered moves
+ * @var ponderHits The number of pondered moves the opponent actually played
  */
 class ConsoleInterface {
 private:
     Agent *agent;
+    std::thread ponderThread;
+    std::atomic<bool> ponderStopSignal = false;
+    std::optional<Board> ponderBoard;
+    std::pair<int, piece_move> ponderResult;
+    unsigned int ponders = 0;
+    unsigned int ponderHits = 0;
+
+    void startPondering(const Game &game, long long remainingTime); ///< Starts searching the position after the expected reply
+    bool stopPondering(const Board &board); ///< Ends the pondering and returns whether it was a ponder hit
 public:
     ConsoleInterface(Agent* agent);
     void run(); ///< Runs the console interface interacting with the agent
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -11,6 +11,9 @@
 
 #include "hyperparameters.hpp"
 
+constexpr int LOSS_SCORE = INT32_MIN + 1; ///< Score of a lost position (not INT32_MIN, so that it can be negated)
+constexpr int WIN_SCORE = -LOSS_SCORE; ///< Score of a won position
+
 /**
  * @class Evaluation
  * @brief Abstract class for evaluation classes.
@@ -17,6 +17,8 @@ const std::string SEARCH_ALGORITHM_ID = "search_algorithm";
 constexpr int USE_RANDOM = 0;
 constexpr int USE_MINIMAX = 1;
 constexpr int USE_ITERATIVE_MINIMAX = 2;
+constexpr int USE_PARALLEL_MINIMAX = 3;
+constexpr int USE_MTDF_MINIMAX = 4;
 
 const std::string PAWN_VALUE_ID = "pawn_value";
 const std::string KING_VALUE_ID = "king_value";
@@ -30,9 +32,43 @@ const std::string MAX_DEPTH_ID = "max_depth";
 
 const std::string USE_CACHE_ID = "use_cache";
 const std::string USE_TRANSPOSITION_TABLE_ID = "use_transposition_table";
+const std::string USE_BOUND_CUTOFFS_ID = "use_bound_cutoffs"; ///< Return cached scores searched with another window when they decide the current one
 
 const std::string REORDER_MOVES_ID = "reorder_moves";
 
+const std::string USE_QUIESCENCE_ID = "use_quiescence";
+const std::string USE_PVS_ID = "use_pvs";
+const std::string USE_KILLER_MOVES_ID = "use_killer_moves";
+const std::string USE_HISTORY_HEURISTIC_ID = "use_history_heuristic";
+const std::string USE_LATE_MOVE_REDUCTIONS_ID = "use_late_move_reductions";
+const std::string USE_PROBCUT_ID = "use_probcut";
+const std::string PROBCUT_MARGIN_ID = "probcut_margin"; ///< Margin over beta a shallow search has to reach to cut the node off
+const std::string PROBCUT_REDUCTION_ID = "probcut_reduction"; ///< Depth reduction of the ProbCut shallow search
+const std::string PROBCUT_MIN_DEPTH_ID = "probcut_min_depth"; ///< Minimal remaining depth of a node tried by ProbCut
+const std::string USE_RAZORING_ID = "use_razoring";
+const std::string RAZORING_MARGINS_ID = "razoring_margins"; ///< Margins below alpha for razoring, by the remaining depth (0 disables a depth)
+const std::string USE_FUTILITY_PRUNING_ID = "use_futility_pruning";
+const std::string FUTILITY_MARGINS_ID = "futility_margins"; ///< Margins below alpha for futility pruning, by the remaining depth (0 disables a depth)
+const std::string LATE_MOVE_REDUCTIONS_ID = "late_move_reductions"; ///< Reductions of quiet moves, rows by the remaining depth, columns by the move number (the last row and column repeat)
+
+const std::string ASPIRATION_WINDOW_ID = "aspiration_window";
+const std::string ASPIRATION_WIDENING_ID = "aspiration_widening";
+
+const std::string RANDOM_SEED_ID = "random_seed"; ///< Negative for a random seed
+
+const std::string THREADS_ID = "threads"; ///< Search threads of IterativeMinimax (Lazy SMP with more than one) and ParallelMinimax
+const std::string MIN_SPLIT_DEPTH_ID = "min_split_depth"; ///< Minimal remaining depth of a node split by ParallelMinimax
+
+const std::string TIME_CHECK_INTERVAL_ID = "time_check_interval"; ///< Nodes searched between two reads of the clock
+
+const std::string TIME_MOVES_TO_GO_ID = "time_moves_to_go"; ///< Expected number of own moves left with all pieces on the board
+const std::string TIME_MAX_FACTOR_ID = "time_max_factor"; ///< Maximum time of a move as a multiple of its optimum time
+const std::string TIME_STABLE_ITERATIONS_ID = "time_stable_iterations"; ///< Iterations with an unchanged best move which halve the time of a move (0 disables)
+const std::string TIME_SCORE_DROP_ID = "time_score_drop"; ///< Score drop between iterations which doubles the time of a move (0 disables)
+const std::string LOG_TIME_USAGE_ID = "log_time_usage"; ///< Print the time usage of each move to the standard error output
+const std::string PONDER_ID = "ponder"; ///< Search the expected reply of the opponent while waiting for it (console interface only)
+const std::string LOG_PONDERING_ID = "log_pondering"; ///< Print the ponder hit rate after each opponent's move to the standard error output
+
 const std::string MOVE_TIME_LIMIT_ID= "move_time_limit";
 const std::string DEBUG_BIT_ID = "debug_bit";
 
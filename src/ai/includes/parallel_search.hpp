@@ -0,0 +1,148 @@
+#ifndef PARALLEL_SEARCH_HPP
+#define PARALLEL_SEARCH_HPP
+
+#include "../../communication/includes/game.hpp"
+#include "../../meta/includes/timer.hpp"
+#include "hyperparameters.hpp"
+#include "cache.hpp"
+#include "evaluation.hpp"
+#include "search_algorithms.hpp"
+#include "time_manager.hpp"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * @struct SplitPoint
+ * @brief A node whose remaining moves are searched by multiple threads.
+ *
+ * Created by the thread searching the node (its owner) once the first move has been searched without a cutoff.
+ * The owner and the threads which stole the split point take the remaining moves one by one, a cutoff aborts all of them.
+ *
+ * @var position The game at the node (copied by the stealing threads)
+ * @var moves The moves of the node
+ * @var nextMove The index of the next move to search
+ * @var leftDepth The remaining depth of the node
+ * @var ply The distance of the node from the root
+ * @var alpha The lower bound of the alpha-beta window (raised by the searched moves)
+ * @var beta The upper bound of the alpha-beta window
+ * @var bestScore The best score found so far
+ * @var bestMove The best move found so far
+ * @var cutoff Whether a move caused a beta cutoff (aborts the searches of the other moves)
+ * @var helpers The number of stealing threads working on the split point
+ * @var parent The split point the owner was working under when it created this one (aborts propagate from it)
+ * @var mutex Guards the move index, the window and the best move
+ */
+struct SplitPoint {
+    Game position;
+    MoveList moves;
+    unsigned int nextMove = 0;
+    int leftDepth = 0;
+    int ply = 0;
+    long long alpha = 0;
+    long long beta = 0;
+    long long bestScore = 0;
+    piece_move bestMove = 0;
+    std::atomic<bool> cutoff = false;
+    std::atomic<int> helpers = 0;
+    SplitPoint *parent = nullptr;
+    std::mutex mutex{};
+};
+
+/**
+ * @struct ParallelWorker
+ * @brief The state of one thread of the parallel search.
+ *
+ * @var index The index of the thread
+ * @var search The sequential search of the nodes below the minimal split depth (shares the cache)
+ * @var splitPoints The split points created by the thread, other threads steal from the front (the oldest, largest subtrees)
+ * @var mutex Guards the split points
+ * @var current The innermost split point the thread is working under (nullptr if none)
+ * @var nodes The number of nodes searched above the minimal split depth
+ * @var splits The number of created split points
+ * @var steals The number of stolen split points
+ */
+struct ParallelWorker {
+    unsigned int index = 0;
+    std::unique_ptr<Minimax> search;
+    std::deque<SplitPoint*> splitPoints;
+    std::mutex mutex;
+    SplitPoint *current = nullptr;
+    uint64_t nodes = 0;
+    uint64_t splits = 0;
+    uint64_t steals = 0;
+};
+
+/**
+ * @struct ParallelSearchStatistics
+ * @brief Counters of the last parallel search (summed over the threads).
+ *
+ * @var nodes The number of visited positions (including the sequential and quiescence search)
+ * @var splits The number of created split points
+ * @var steals The number of split points joined by other threads than their owner
+ */
+struct ParallelSearchStatistics {
+    uint64_t nodes = 0;
+    uint64_t splits = 0;
+    uint64_t steals = 0;
+};
+
+/**
+ * @class ParallelMinimax
+ * @brief Parallel iterative deepening alpha-beta search (Young Brothers Wait Concept).
+ *
+ * A node is split between threads only after its first move (the eldest brother) has been searched, so the alpha bound
+ * the other moves are searched with is already good. Idle threads steal split points from the deques of the other threads,
+ * a beta cutoff at a split point aborts the searches of its remaining moves. Nodes below the minimal split depth are searched
+ * sequentially by Minimax. All threads share one cache. The owner of a split point waiting for the threads still searching its moves
+ * helps them by stealing the split points they created below it (helpful master).
+ * The time of each move is budgeted by a TimeManager, like in IterativeMinimax.
+ * More here: https://www.chessprogramming.org/Young_Brothers_Wait_Concept.
+ *
+ * @var maxDepth The maximum depth of the search
+ * @var timeManager Decides how long the search of each move runs
+ * @var minSplitDepth The minimal remaining depth of a node to be split
+ * @var useCache Whether to use a cache
+ * @var useTranspositionTable Whether to consider the cache results as final and return them
+ * @var cache The cache shared by the threads
+ * @var workers The state of each thread (the first one is the calling thread)
+ * @var idleWorkers The number of threads looking for a split point to steal
+ * @var stopSignal Ends the search of all threads
+ * @var externalStopSignal Set from outside to end the search early (optional)
+ * @var statistics The statistics of the last search
+ */
+class ParallelMinimax : public SearchAlgorithm {
+private:
+    int maxDepth;
+    TimeManager timeManager;
+    int minSplitDepth;
+    bool useCache;
+    bool useTranspositionTable;
+    std::shared_ptr<Cache<>> cache;
+    std::vector<std::unique_ptr<ParallelWorker>> workers;
+    std::atomic<int> idleWorkers = 0;
+    std::atomic<bool> stopSignal = false;
+    const std::atomic<bool> *externalStopSignal = nullptr;
+    ParallelSearchStatistics statistics;
+
+    std::pair<int, piece_move> search(ParallelWorker &worker, Game &game, const Timer& timer, int ply, int leftDepth, long long alpha, long long beta);
+    void searchSplitPoint(ParallelWorker &worker, SplitPoint &splitPoint, Game &game, const Timer& timer);
+    void joinSplitPoint(ParallelWorker &worker, SplitPoint &splitPoint, const Timer& timer); ///< Searches moves of a stolen split point and leaves it
+    bool isAborted(const ParallelWorker &worker, const Timer& timer) const;
+    bool isInterrupted(const Timer& timer) const; ///< Returns whether the time is up or the external stop signal is set
+    SplitPoint *stealSplitPoint(unsigned int thief, const SplitPoint *ancestor = nullptr);
+    void runHelper(unsigned int index, const Timer& timer);
+
+public:
+    ParallelMinimax(Hyperparameters &hyperparameters, Evaluation &evaluation);
+    std::pair<int, piece_move> findBestMove(Game &game, const Timer& timer) override;
+    void setStopSignal(const std::atomic<bool> *signal) override;
+    piece_move getExpectedMove(Game &game) override;
+    void setMaxDepth(int newDepth);
+    const ParallelSearchStatistics& getStatistics() const; ///< Returns the statistics of the last search
+};
+
+#endif // PARALLEL_SEARCH_HPP
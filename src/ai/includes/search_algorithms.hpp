@@ -7,6 +7,11 @@
 #include "hyperparameters.hpp"
 #include "cache.hpp"
 #include "evaluation.hpp"
+#include "time_manager.hpp"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 #include <random>
@@ -20,9 +25,57 @@
 class SearchAlgorithm {
 public:
     virtual std::pair<int, piece_move> findBestMove(Game &game, const Timer& timer) = 0;
+    virtual void setStopSignal(const std::atomic<bool> *) {} ///< Sets a flag which ends the search early when set (nullptr for none)
+    virtual piece_move getExpectedMove(Game &) { return 0; } ///< Returns the best move of the position remembered from earlier searches (0 if unknown)
     virtual ~SearchAlgorithm() = default;
 };
 
+/**
+ * @struct SearchStatistics
+ * @brief Counters collected by the search (used by benchmarks and for tuning).
+ *
+ * @var nodes The number of positions visited by the main search
+ * @var quiescenceNodes The number of positions visited by the quiescence search
+ * @var researches The number of full-window re-searches after a failed null-window search (principal variation search)
+ * @var cutoffs The number of beta cutoffs
+ * @var firstMoveCutoffs The number of beta cutoffs caused by the first searched move (measures the quality of the move ordering)
+ * @var reductions The number of moves searched with a late move reduction
+ * @var reductionResearches The number of reduced moves searched again to the full depth after beating alpha
+ * @var probCuts The number of nodes cut off by ProbCut
+ * @var razorCuts The number of nodes cut off by razoring
+ * @var futilityPrunes The number of moves skipped by futility pruning
+ * @var boundCutoffs The number of nodes decided by a cached bound searched with another window
+ * @var probes The number of null-window searches of the root (filled by MtdfMinimax)
+ * @var aspirationFails The number of iteration searches whose score fell outside of the aspiration window (filled by IterativeMinimax)
+ * @var milliseconds The duration of the iteration (filled by IterativeMinimax)
+ */
+struct SearchStatistics {
+    uint64_t nodes = 0;
+    uint64_t quiescenceNodes = 0;
+    uint64_t researches = 0;
+    uint64_t cutoffs = 0;
+    uint64_t firstMoveCutoffs = 0;
+    uint64_t reductions = 0;
+    uint64_t reductionResearches = 0;
+    uint64_t probCuts = 0;
+    uint64_t razorCuts = 0;
+    uint64_t futilityPrunes = 0;
+    uint64_t boundCutoffs = 0;
+    uint64_t probes = 0;
+    uint64_t aspirationFails = 0;
+    long long milliseconds = 0;
+};
+
+constexpr int MAX_SEARCH_PLY = 64; ///< The number of plies with killer move slots
+constexpr long long MAX_PRUNING_BOUND = 1000000; ///< Bounds beyond it (infinite windows, wins and losses) disable forward pruning
+
+/**
+ * @brief Returns the index of the first step direction of a move (0-3), used to index the history table
+ */
+inline unsigned int historyDirection(piece_move move){
+    return ((move >> 5) & 0x7) - 1;
+}
+
 /**
  * @class Minimax
  * @brief Minimax search algorithm.
@@ -33,30 +86,99 @@ public:
  * @var useAlphaBeta Whether to use alpha-beta pruning
  * @var useCache Whether to use a cache
  * @var useTranspositionTable Whether to consider the cache results as final and return them
+ * @var useBoundCutoffs Whether to also return the cache results searched with another window if they are bounds deciding the current window
  * @var reorderMoves Whether to reorder moves
+ * @var useQuiescence Whether to resolve pending captures before evaluating the leaves
+ * @var usePvs Whether to use principal variation search (null-window search of all moves but the first one)
+ * @var useKillerMoves Whether to search the quiet moves which caused the last beta cutoffs at the same ply first
+ * @var useHistoryHeuristic Whether to order quiet moves by how often (and how deep) they caused beta cutoffs
+ * @var useLateMoveReductions Whether to search late quiet moves to a reduced depth first (searched again to the full depth if they beat alpha)
+ * @var lateMoveReductions The reduction of a quiet move indexed by the remaining depth and by the number of moves searched before it
+ * @var useProbCut Whether to cut nodes off when a shallow search beats beta by a margin (ProbCut)
+ * @var probCutMargin The margin the shallow search has to beat beta by
+ * @var probCutReduction The depth reduction of the shallow search
+ * @var probCutMinDepth The minimal remaining depth of a node tried by ProbCut
+ * @var razoringMargins The margins below alpha from which a quiet node is verified by a one ply search (by the remaining depth, empty if disabled)
+ * @var futilityMargins The margins below alpha from which the late quiet moves of a node are skipped (by the remaining depth, empty if disabled)
  * @var maxDepth The maximum depth of the search
  * @var moveTimeLimit The time limit for each move
  * @var evaluation The evaluation algorithm
- * @var cache The cache for storing best moves and scores
- * @var randomEngine Random engine used for non-deterministic moves
+ * @var cache The cache for storing best moves and scores (shared by the threads of a parallel search)
+ * @var randomEngine Random engine breaking ties between equally scored root moves (seeded by random_seed)
+ * @var statistics The counters of the search
+ * @var ply The distance of the current node from the root
+ * @var killerMoves The two latest quiet moves which caused a beta cutoff at each ply
+ * @var history The history scores of quiet moves indexed by the side, the starting square and the first direction of the move
+ * @var stopSignal Stops the search when set, in addition to the timer (optional, set by helper threads, pondering or tournaments)
+ * @var timeCheckInterval The number of nodes between two reads of the clock
+ * @var nodesUntilTimeCheck The number of nodes left until the clock is read again
+ * @var stopped Whether the search was stopped (by the timer or the stop signal), stays set until the next search
  */
 class Minimax : public SearchAlgorithm {
 private:
     bool useAlphaBeta;
     bool useCache;
     bool useTranspositionTable;
+    bool useBoundCutoffs;
     bool reorderMoves;
+    bool useQuiescence;
+    bool usePvs;
+    bool useKillerMoves;
+    bool useHistoryHeuristic;
+    bool useLateMoveReductions;
+    std::array<std::array<uint8_t, MAX_MOVES>, MAX_SEARCH_PLY> lateMoveReductions{};
+    bool useProbCut;
+    int probCutMargin;
+    int probCutReduction;
+    int probCutMinDepth;
+    std::vector<int> razoringMargins;
+    std::vector<int> futilityMargins;
     int maxDepth;
     long long moveTimeLimit; // Milliseconds
     Evaluation &evaluation;
-    Cache<> cache; // Assuming template specialization if needed
+    std::shared_ptr<Cache<>> cache;
     std::mt19937 randomEngine;
+    SearchStatistics statistics;
+    int ply = 0;
+    std::array<std::array<piece_move, 2>, MAX_SEARCH_PLY> killerMoves{};
+    std::array<std::array<std::array<uint32_t, 4>, NUM_SQUARES>, 2> history{};
+    const std::atomic<bool> *stopSignal = nullptr;
+    int timeCheckInterval;
+    int nodesUntilTimeCheck = 0;
+    bool stopped = false;
+
+    /**
+     * @brief Returns whether the search has to end, reads the clock only once per timeCheckInterval nodes (the stop signal on every call)
+     */
+    inline bool isStopped(const Timer& timer) {
+        if(!stopped && nodesUntilTimeCheck <= 0)
+        {
+            nodesUntilTimeCheck = timeCheckInterval;
+            stopped = timer.isFinished();
+        }
+        if(!stopped && stopSignal && stopSignal->load(std::memory_order_relaxed))
+            stopped = true;
+        return stopped;
+    }
+    void orderQuietMoves(MoveList &moves, bool nextBlack);
+    void updateMoveOrdering(piece_move move, bool nextBlack, int leftDepth);
+    int getReduction(int leftDepth, unsigned int moveNumber) const; ///< Returns the late move reduction of a quiet move (0 for none)
 
 public:
-    Minimax(Hyperparameters &hyperparameters, Evaluation &evaluation);
-    std::pair<int, piece_move> minimax(Game &game, const Timer& timer, int leftDepth, long long alpha = INT32_MIN, long long beta = INT32_MIN);
+    Minimax(Hyperparameters &hyperparameters, Evaluation &evaluation, std::shared_ptr<Cache<>> sharedCache = nullptr, unsigned int seedOffset = 0);
+    std::pair<int, piece_move> minimax(Game &game, const Timer& timer, int leftDepth, long long alpha = INT32_MIN, long long beta = INT32_MAX);
+    std::pair<int, piece_move> searchNode(Game &game, const Timer& timer, int nodePly, int leftDepth, long long alpha, long long beta); ///< Searches a node at the given distance from the root of another search
+    int quiescence(Game &game, const Timer& timer, long long alpha, long long beta);
     std::pair<int, piece_move> findBestMove(Game &game, const Timer& timer) override;
     void setMaxDepth(int newDepth);
+    const SearchStatistics& getStatistics() const;
+    void resetStatistics();
+    void prepareSearch(); ///< Resets the move ordering state and the stop state before searching a new root
+    std::shared_ptr<Cache<>> getCache() const; ///< Returns the cache, so other searches can share it
+    void setStopSignal(const std::atomic<bool> *signal) override;
+    piece_move getExpectedMove(Game &game) override;
+    bool wasStopped() const; ///< Returns whether the search since the last prepareSearch was stopped (its results are incomplete then)
+    const std::array<piece_move, 2>& getKillerMoves(int killerPly) const; ///< Returns the killer moves of the ply
 };
 
 /**
@@ -66,19 +188,73 @@ public:
  * Searches the best move in a given game state using the minimax algorithm with iterative deepening.
  * More here: https://en.wikipedia.org/wiki/Iterative_deepening_depth-first_search.
  *
- * @var minimax The minimax search algorithm
+ * With more than one thread it runs a Lazy SMP search: helper threads search the same root with their own iterative deepening
+ * (every other helper one ply deeper) and fill the shared cache, which speeds up the search of the main thread.
+ * Only the result of the main thread is reported, the helpers are stopped by a single signal once it finishes.
+ *
+ * @var minimax The minimax search algorithm (of the main thread)
  * @var maxDepth The maximum depth of the search
- * @var moveTimeLimit The time limit for each move
+ * @var timeManager Decides how long the search of each move runs
+ * @var aspirationWindow The distance of the aspiration window bounds from the previous score (0 disables aspiration windows)
+ * @var aspirationWidening The factor widening the failed side of the aspiration window (at least 2)
+ * @var iterationStatistics The statistics of each iteration of the last search (of the main thread)
+ * @var helpers The searches of the helper threads (threads - 1 of them), sharing the cache of the main search
+ * @var stopSignal Stops the helper threads
  */
 class IterativeMinimax : public SearchAlgorithm {
 private:
     Minimax minimax;
     int maxDepth;
-    long long moveTimeLimit;
+    TimeManager timeManager;
+    int aspirationWindow;
+    int aspirationWidening;
+    std::vector<SearchStatistics> iterationStatistics;
+    std::vector<std::unique_ptr<Minimax>> helpers;
+    std::atomic<bool> stopSignal = false;
+
+    std::pair<int, piece_move> searchIteration(Game &game, const Timer& timer, int depth, std::optional<int> previousScore, unsigned int &aspirationFails);
+    void runHelper(Minimax &helper, Game game, const Timer& timer, int firstDepth);
 
 public:
     IterativeMinimax(Hyperparameters &hyperparameters, Evaluation &evaluation);
     std::pair<int, piece_move> findBestMove(Game &game, const Timer& timer) override;
+    void setStopSignal(const std::atomic<bool> *signal) override; ///< Stops the main search, the helper threads stop with it
+    piece_move getExpectedMove(Game &game) override;
+    const std::vector<SearchStatistics>& getIterationStatistics() const; ///< Returns the statistics of each iteration of the last search
+};
+
+/**
+ * @class MtdfMinimax
+ * @brief Iterative deepening MTD(f) search algorithm.
+ *
+ * Each iteration converges on the minimax value by a series of null-window searches (probes) of the root, starting from
+ * the score of the previous iteration. Every probe tells whether the value is above or below its window, the bounds close
+ * in until they meet. The probes search mostly the same tree, so the search relies on the cache (best moves and, with
+ * use_bound_cutoffs, the bounds of the previous probes).
+ * More here: https://en.wikipedia.org/wiki/MTD(f).
+ *
+ * @var minimax The minimax search algorithm running the probes
+ * @var evaluation The evaluation algorithm (its score of the root is the first guess)
+ * @var maxDepth The maximum depth of the search
+ * @var timeManager Decides how long the search of each move runs
+ * @var iterationStatistics The statistics of each iteration of the last search
+ */
+class MtdfMinimax : public SearchAlgorithm {
+private:
+    Minimax minimax;
+    Evaluation &evaluation;
+    int maxDepth;
+    TimeManager timeManager;
+    std::vector<SearchStatistics> iterationStatistics;
+
+    std::pair<int, piece_move> mtdf(Game &game, const Timer& timer, int depth, int firstGuess, uint64_t &probes);
+
+public:
+    MtdfMinimax(Hyperparameters &hyperparameters, Evaluation &evaluation);
+    std::pair<int, piece_move> findBestMove(Game &game, const Timer& timer) override;
+    void setStopSignal(const std::atomic<bool> *signal) override;
+    piece_move getExpectedMove(Game &game) override;
+    const std::vector<SearchStatistics>& getIterationStatistics() const; ///< Returns the statistics of each iteration of the last search
 };
 
 /**
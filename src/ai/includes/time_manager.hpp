@@ -0,0 +1,74 @@
+#ifndef TIME_MANAGER_HPP
+#define TIME_MANAGER_HPP
+
+#include <chrono>
+#include <string>
+
+#include "../../communication/includes/game.hpp"
+#include "hyperparameters.hpp"
+
+constexpr int MIN_MOVES_TO_GO = 8; ///< The number of moves the remaining time is split into at least (endgames can take long)
+
+/**
+ * @class TimeManager
+ * @brief Decides how long the iterative deepening search of one move may run.
+ *
+ * The remaining time is split between the moves which are expected to be left (estimated from the number of pieces), giving the optimum time.
+ * The search stops once the optimum time is spent or once the next iteration is predicted (from the effective branching factor) not to finish in time.
+ * The optimum time is shortened if the best move stays stable over several iterations and extended if the score drops,
+ * the maximum time (the hard limit of the timer) is never exceeded.
+ *
+ * @var movesToGo The expected number of moves left with all pieces on the board
+ * @var maxTimeFactor How many times the optimum time the maximum time may be
+ * @var stableIterations The number of iterations with the same best move after which the optimum time is halved (0 disables it)
+ * @var scoreDrop The score drop between iterations after which the optimum time is doubled (0 disables it)
+ * @var logTimeUsage Whether to print the time usage of each move to the standard error output
+ * @var moveTimeLimit The time limit for each move
+ * @var start The start of the search of the current move
+ * @var expectedMoves The expected number of moves left in the current move
+ * @var optimumTime The time the search of the current move should take (microseconds)
+ * @var maximumTime The time the search of the current move must not exceed (microseconds)
+ * @var lastIterationTime The duration of the last finished iteration (microseconds)
+ * @var previousIterationTime The duration of the iteration before the last one (microseconds)
+ * @var depth The depth of the last finished iteration
+ * @var bestMove The best move of the last finished iteration
+ * @var bestMoveStability The number of consecutive iterations which found the same best move
+ * @var lastScore The score of the last finished iteration
+ * @var scoreDropped Whether the score dropped during the search of the current move
+ * @var stopReason Why the last decision ended the search (for the time usage log)
+ */
+class TimeManager {
+private:
+    int movesToGo;
+    int maxTimeFactor;
+    int stableIterations;
+    int scoreDrop;
+    bool logTimeUsage;
+    long long moveTimeLimit;
+
+    std::chrono::steady_clock::time_point start;
+    int expectedMoves = 0;
+    long long optimumTime = 0;
+    long long maximumTime = 0;
+    long long lastIterationTime = 0;
+    long long previousIterationTime = 0;
+    int depth = 0;
+    piece_move bestMove = 0;
+    int bestMoveStability = 0;
+    int lastScore = 0;
+    bool scoreDropped = false;
+    std::string stopReason;
+
+    long long getTargetTime() const; ///< Returns the optimum time adjusted by the best move stability and the score drop (microseconds)
+
+public:
+    explicit TimeManager(Hyperparameters &hyperparameters);
+    void startMove(const GameState &gameState, long long remainingTime); ///< Computes the time budget of a move (remaining time of the player in milliseconds)
+    long long getMaximumTime() const; ///< Returns the hard time limit of the current move in milliseconds
+    long long getElapsedTime() const; ///< Returns the time spent on the current move in microseconds
+    void recordIteration(int depth, piece_move bestMove, int score, long long microseconds); ///< Records a finished iteration
+    bool shouldStartIteration(); ///< Returns whether the next iteration is worth starting
+    void finishMove(bool interrupted); ///< Logs the time usage of the move (if enabled)
+};
+
+#endif // TIME_MANAGER_HPP
@@ -0,0 +1,352 @@
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "includes/parallel_search.hpp"
+
+ParallelMinimax::ParallelMinimax(Hyperparameters &hyperparameters, Evaluation &eval)
+        : maxDepth(hyperparameters.get<int>(MAX_DEPTH_ID)), timeManager(hyperparameters),
+        minSplitDepth(std::max(hyperparameters.get<int>(MIN_SPLIT_DEPTH_ID), 1)),
+        useCache(hyperparameters.get<bool>(USE_CACHE_ID)), useTranspositionTable(hyperparameters.get<bool>(USE_TRANSPOSITION_TABLE_ID))
+{
+    const int threads = std::max(hyperparameters.get<int>(THREADS_ID), 1);
+    for(int i = 0; i < threads; i++)
+    {
+        auto worker = std::make_unique<ParallelWorker>();
+        worker->index = i;
+        worker->search = std::make_unique<Minimax>(hyperparameters, eval, cache, i); // The first worker creates the cache
+        worker->search->setStopSignal(&stopSignal);
+        cache = worker->search->getCache();
+        workers.push_back(std::move(worker));
+    }
+}
+
+/**
+ * @brief Parallel iterative deepening alpha-beta search, the calling thread searches the root and the others steal split points.
+ * @param game The game manager class allowing for game state manipulation and available moves retrieval.
+ * @param timer Allows for termination of the search algorithm after a specified time limit.
+ * @return The best move found by the search algorithm and its score.
+ */
+std::pair<int, piece_move> ParallelMinimax::findBestMove(Game &game, const Timer& timer)
+{
+    const GameState& gameState = game.getGameState();
+
+    std::pair<int, piece_move> bestMove;
+    bestMove.first = LOSS_SCORE;
+    bestMove.second = gameState.getAvailableMoves()[0];
+
+    timeManager.startMove(gameState, timer.getRemainingTime());
+    Timer localTimer = Timer(timeManager.getMaximumTime());
+    localTimer.resume();
+
+    for(auto &worker : workers)
+    {
+        worker->search->prepareSearch();
+        worker->search->resetStatistics();
+        worker->nodes = worker->splits = worker->steals = 0;
+    }
+
+    stopSignal = false;
+    std::vector<std::thread> helperThreads;
+    for(unsigned int i = 1; i < workers.size(); i++)
+        helperThreads.emplace_back(&ParallelMinimax::runHelper, this, i, std::cref(localTimer));
+
+    bool interrupted = false;
+    for(int i = 1; i <= maxDepth; ++i)
+    {
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        std::pair<int, piece_move> candidate = search(*workers[0], game, localTimer, 0, i, INT32_MIN, INT32_MAX);
+        interrupted = isInterrupted(localTimer);
+
+        if(candidate.second != 0 && !interrupted)
+        {
+            bestMove = candidate;
+            timeManager.recordIteration(i, bestMove.second, bestMove.first, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count());
+        }
+
+        if(bestMove.first==WIN_SCORE || candidate.second == 0 || interrupted) // If winning path was found or the search was interrupted, end
+        {
+            break;
+        }
+        if(i < maxDepth && !timeManager.shouldStartIteration()) // The next iteration is not expected to pay off
+        {
+            break;
+        }
+    }
+
+    stopSignal = true;
+    for(std::thread &thread : helperThreads)
+        thread.join();
+    timeManager.finishMove(interrupted);
+
+    statistics = ParallelSearchStatistics();
+    for(auto &worker : workers)
+    {
+        statistics.nodes += worker->nodes + worker->search->getStatistics().nodes + worker->search->getStatistics().quiescenceNodes;
+        statistics.splits += worker->splits;
+        statistics.steals += worker->steals;
+    }
+
+    return bestMove;
+}
+
+/**
+ * @brief Alpha-beta search of a node (in the negamax form), splits the node once its first move has been searched and a thread is idle.
+ * @param worker The state of the searching thread.
+ * @param game The game manager class allowing for game state manipulation and available moves retrieval.
+ * @param timer Allows for termination of the search algorithm after a specified time limit.
+ * @param ply The distance of the node from the root.
+ * @param leftDepth The remaining depth of the search.
+ * @param alpha The lower bound of the alpha-beta window.
+ * @param beta The upper bound of the alpha-beta window.
+ * @return The best move found by the search algorithm and its score (meaningless if the search was aborted).
+ */
+std::pair<int, piece_move> ParallelMinimax::search(ParallelWorker &worker, Game &game, const Timer& timer, int ply, int leftDepth, long long alpha, long long beta)
+{
+    if(leftDepth < minSplitDepth) // Too little work to share
+        return worker.search->searchNode(game, timer, ply, leftDepth, alpha, beta);
+
+    worker.nodes++;
+    const long long lowerBound = alpha;
+    const long long upperBound = beta;
+    MoveList moves = game.getGameState().getAvailableMoves(); // Copy, the game state view is rebuilt after every move
+
+    if(useCache)
+    {
+        const CacheEntry cacheInfo = cache->get(game);
+        if(cacheInfo.bestMove != 0)
+        {
+            auto it = std::find(moves.begin(), moves.end(), cacheInfo.bestMove);
+            if(it != moves.end())
+                std::iter_swap(moves.begin(), it);
+        }
+        if(useTranspositionTable && leftDepth == cacheInfo.depth && clampScore(upperBound) == cacheInfo.upperBound && clampScore(lowerBound) == cacheInfo.lowerBound)
+            return {cacheInfo.score, cacheInfo.bestMove};
+    }
+
+    if(moves.empty()) // No moves available = loss
+        return {LOSS_SCORE, 0};
+
+    long long bestScore = INT32_MIN;
+    piece_move bestMove = 0;
+    for(unsigned int i = 0; i < moves.size(); i++)
+    {
+        if(isAborted(worker, timer))
+            break;
+
+        // Young brothers wait: the node is shared only after the eldest brother has been searched, and only with more than one move left
+        if(i > 0 && moves.size() - i > 1 && idleWorkers.load(std::memory_order_relaxed) > 0)
+        {
+            SplitPoint splitPoint{.position = game, .moves = moves, .nextMove = i, .leftDepth = leftDepth, .ply = ply, .alpha = alpha, .beta = beta,
+                                  .bestScore = bestScore, .bestMove = bestMove, .parent = worker.current};
+            {
+                std::lock_guard<std::mutex> lock(worker.mutex);
+                worker.splitPoints.push_back(&splitPoint);
+            }
+            worker.splits++;
+            worker.current = &splitPoint;
+            searchSplitPoint(worker, splitPoint, game, timer);
+            {
+                std::lock_guard<std::mutex> lock(worker.mutex);
+                worker.splitPoints.erase(std::find(worker.splitPoints.begin(), worker.splitPoints.end(), &splitPoint));
+            }
+            // No thread can join the split point anymore, help those still searching its moves until they finish
+            while(splitPoint.helpers.load() > 0)
+            {
+                if(SplitPoint *helped = stealSplitPoint(worker.index, &splitPoint))
+                    joinSplitPoint(worker, *helped, timer);
+                else
+                    std::this_thread::yield();
+            }
+            worker.current = splitPoint.parent;
+
+            bestScore = splitPoint.bestScore;
+            bestMove = splitPoint.bestMove;
+            break;
+        }
+
+        game.makeMoveUnchecked(moves[i]);
+        long long score = -search(worker, game, timer, ply+1, leftDepth-1, -beta, -alpha).first;
+        game.undoMove();
+        if(isAborted(worker, timer))
+            break;
+
+        if(score > bestScore)
+        {
+            bestScore = score;
+            bestMove = moves[i];
+        }
+        alpha = std::max(alpha, bestScore);
+        if(alpha >= beta)
+            break;
+    }
+
+    if(isAborted(worker, timer))
+        return {LOSS_SCORE, bestMove};
+
+    if(useCache)
+        cache->set(game, leftDepth, bestScore, upperBound, lowerBound, bestMove);
+
+    return {bestScore, bestMove};
+}
+
+/**
+ * @brief Searches the remaining moves of a split point one by one until none is left or a move causes a cutoff.
+ * @param worker The state of the searching thread (working under the split point).
+ * @param splitPoint The split point.
+ * @param game The game in the position of the split point (owned by the searching thread).
+ * @param timer Allows for termination of the search algorithm after a specified time limit.
+ */
+void ParallelMinimax::searchSplitPoint(ParallelWorker &worker, SplitPoint &splitPoint, Game &game, const Timer& timer)
+{
+    while(true)
+    {
+        piece_move move;
+        long long alpha;
+        {
+            std::lock_guard<std::mutex> lock(splitPoint.mutex);
+            if(splitPoint.cutoff || splitPoint.nextMove >= splitPoint.moves.size())
+                return;
+            move = splitPoint.moves[splitPoint.nextMove++];
+            alpha = splitPoint.alpha;
+        }
+
+        game.makeMoveUnchecked(move);
+        long long score = -search(worker, game, timer, splitPoint.ply+1, splitPoint.leftDepth-1, -splitPoint.beta, -alpha).first;
+        game.undoMove();
+        if(isAborted(worker, timer)) // Also after a cutoff by another move of the split point
+            return;
+
+        std::lock_guard<std::mutex> lock(splitPoint.mutex);
+        if(score > splitPoint.bestScore)
+        {
+            splitPoint.bestScore = score;
+            splitPoint.bestMove = move;
+        }
+        splitPoint.alpha = std::max(splitPoint.alpha, splitPoint.bestScore);
+        if(splitPoint.alpha >= splitPoint.beta)
+            splitPoint.cutoff = true;
+    }
+}
+
+/**
+ * @brief Searches the remaining moves of a split point joined by stealSplitPoint, then leaves it.
+ *
+ * The thread may already work under another split point (helpful master), it returns under it afterwards.
+ * @param worker The state of the joining thread.
+ * @param splitPoint The joined split point.
+ * @param timer Allows for termination of the search algorithm after a specified time limit.
+ */
+void ParallelMinimax::joinSplitPoint(ParallelWorker &worker, SplitPoint &splitPoint, const Timer& timer)
+{
+    worker.steals++;
+    SplitPoint *previous = worker.current;
+    Game game = splitPoint.position;
+    worker.current = &splitPoint;
+    searchSplitPoint(worker, splitPoint, game, timer);
+    worker.current = previous;
+    splitPoint.helpers--; // The owner may destroy the split point from now on
+}
+
+/**
+ * @brief Returns whether the search of the thread should end (the search is over, or a split point it works under was cut off)
+ */
+bool ParallelMinimax::isAborted(const ParallelWorker &worker, const Timer& timer) const
+{
+    if(stopSignal.load(std::memory_order_relaxed) || isInterrupted(timer))
+        return true;
+    for(const SplitPoint *splitPoint = worker.current; splitPoint; splitPoint = splitPoint->parent)
+        if(splitPoint->cutoff.load(std::memory_order_relaxed))
+            return true;
+    return false;
+}
+
+bool ParallelMinimax::isInterrupted(const Timer& timer) const
+{
+    return timer.isFinished() || (externalStopSignal && externalStopSignal->load(std::memory_order_relaxed));
+}
+
+/**
+ * @brief Returns whether the split point was created under the ancestor (directly or through other split points)
+ */
+inline bool isBelow(const SplitPoint *splitPoint, const SplitPoint *ancestor)
+{
+    for(const SplitPoint *parent = splitPoint->parent; parent; parent = parent->parent)
+        if(parent == ancestor)
+            return true;
+    return false;
+}
+
+/**
+ * @brief Finds a split point of another thread with moves left and joins it.
+ *
+ * The split points are taken from the front of the deques, the oldest split points are the closest to the root and have the largest subtrees.
+ * The split point stays valid until the thief leaves it (its owner waits for all joined threads).
+ * @param thief The index of the stealing thread.
+ * @param ancestor If set, only split points below it are joined (the owner of the ancestor helps the threads it waits for).
+ * @return The joined split point (nullptr if none has moves left).
+ */
+SplitPoint *ParallelMinimax::stealSplitPoint(unsigned int thief, const SplitPoint *ancestor)
+{
+    for(unsigned int offset = 1; offset < workers.size(); offset++)
+    {
+        ParallelWorker &victim = *workers[(thief + offset) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        for(SplitPoint *splitPoint : victim.splitPoints)
+        {
+            if(ancestor && !isBelow(splitPoint, ancestor))
+                continue;
+            std::lock_guard<std::mutex> splitPointLock(splitPoint->mutex);
+            if(!splitPoint->cutoff && splitPoint->nextMove < splitPoint->moves.size())
+            {
+                splitPoint->helpers++;
+                return splitPoint;
+            }
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Loop of a helper thread, steals split points until the search ends.
+ * @param index The index of the thread.
+ * @param timer The timer of the search.
+ */
+void ParallelMinimax::runHelper(unsigned int index, const Timer& timer)
+{
+    ParallelWorker &worker = *workers[index];
+    idleWorkers++;
+    while(!stopSignal.load(std::memory_order_relaxed))
+    {
+        SplitPoint *splitPoint = stealSplitPoint(index);
+        if(!splitPoint)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        idleWorkers--;
+        joinSplitPoint(worker, *splitPoint, timer);
+        idleWorkers++;
+    }
+    idleWorkers--;
+}
+
+void ParallelMinimax::setStopSignal(const std::atomic<bool> *signal)
+{
+    externalStopSignal = signal;
+}
+
+piece_move ParallelMinimax::getExpectedMove(Game &game)
+{
+    return workers[0]->search->getExpectedMove(game); // The workers share the cache
+}
+
+void ParallelMinimax::setMaxDepth(int newDepth)
+{
+    maxDepth = newDepth;
+}
+
+const ParallelSearchStatistics& ParallelMinimax::getStatistics() const
+{
+    return statistics;
+}
@@ -1,66 +1,103 @@
 #include <random>
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <thread>
 
 #include "includes/search_algorithms.hpp"
 #include "../communication/includes/debugging.hpp"
 #include "../communication/includes/game.hpp"
 
-Minimax::Minimax(Hyperparameters &hyperparameters, Evaluation &eval)
-        : evaluation(eval), cache(), maxDepth(hyperparameters.get<int>(MAX_DEPTH_ID)), useAlphaBeta(hyperparameters.get<bool>(USE_ALPHA_BETA_ID)),
+/**
+ * @brief Returns the seed of the random engine of the search
+ * @param randomSeed The configured seed, a negative value requests a random seed (games are not reproducible then)
+ */
+unsigned int getRandomSeed(int randomSeed)
+{
+    if(randomSeed < 0)
+        return std::random_device()();
+    return static_cast<unsigned int>(randomSeed);
+}
+
+Minimax::Minimax(Hyperparameters &hyperparameters, Evaluation &eval, std::shared_ptr<Cache<>> sharedCache, unsigned int seedOffset)
+        : evaluation(eval), cache(sharedCache ? std::move(sharedCache) : std::make_shared<Cache<>>()), maxDepth(hyperparameters.get<int>(MAX_DEPTH_ID)), useAlphaBeta(hyperparameters.get<bool>(USE_ALPHA_BETA_ID)),
         useCache(hyperparameters.get<bool>(USE_CACHE_ID)), useTranspositionTable(hyperparameters.get<bool>(USE_TRANSPOSITION_TABLE_ID)),
-        reorderMoves(hyperparameters.get<bool>(REORDER_MOVES_ID)),
-        moveTimeLimit(hyperparameters.get<long long>(MOVE_TIME_LIMIT_ID)), randomEngine(std::random_device()())
+        useBoundCutoffs(hyperparameters.get<bool>(USE_BOUND_CUTOFFS_ID)), reorderMoves(hyperparameters.get<bool>(REORDER_MOVES_ID)),
+        useQuiescence(hyperparameters.get<bool>(USE_QUIESCENCE_ID)), usePvs(hyperparameters.get<bool>(USE_PVS_ID)),
+        useKillerMoves(hyperparameters.get<bool>(USE_KILLER_MOVES_ID)), useHistoryHeuristic(hyperparameters.get<bool>(USE_HISTORY_HEURISTIC_ID)),
+        useLateMoveReductions(hyperparameters.get<bool>(USE_LATE_MOVE_REDUCTIONS_ID)),
+        useProbCut(hyperparameters.get<bool>(USE_PROBCUT_ID)), probCutMargin(hyperparameters.get<int>(PROBCUT_MARGIN_ID)),
+        probCutReduction(std::max(hyperparameters.get<int>(PROBCUT_REDUCTION_ID), 1)),
+        probCutMinDepth(std::max(hyperparameters.get<int>(PROBCUT_MIN_DEPTH_ID), probCutReduction + 1)), // The shallow search is at least one ply deep
+        moveTimeLimit(hyperparameters.get<long long>(MOVE_TIME_LIMIT_ID)), randomEngine(getRandomSeed(hyperparameters.get<int>(RANDOM_SEED_ID)) + seedOffset),
+        timeCheckInterval(std::max(hyperparameters.get<int>(TIME_CHECK_INTERVAL_ID), 1))
 {
+    // Expand the configured table to all depths and move numbers, the last row and the last column repeat
+    const auto reductions = hyperparameters.get<std::vector<std::vector<int>>>(LATE_MOVE_REDUCTIONS_ID);
+    for(int depth = 0; depth < MAX_SEARCH_PLY && !reductions.empty(); depth++)
+    {
+        const std::vector<int> &row = reductions[std::min<size_t>(depth, reductions.size() - 1)];
+        for(unsigned int move = 0; move < MAX_MOVES && !row.empty(); move++)
+            lateMoveReductions[depth][move] = std::clamp(row[std::min<size_t>(move, row.size() - 1)], 0, MAX_SEARCH_PLY);
+    }
+    if(hyperparameters.get<bool>(USE_RAZORING_ID))
+        razoringMargins = hyperparameters.get<std::vector<int>>(RAZORING_MARGINS_ID);
+    if(hyperparameters.get<bool>(USE_FUTILITY_PRUNING_ID))
+        futilityMargins = hyperparameters.get<std::vector<int>>(FUTILITY_MARGINS_ID);
 }
 
 /**
- * @brief Minimax search algorithm.
+ * @brief Minimax search algorithm (in the negamax form, scores are from the perspective of the player to move).
  * @param game The game manager class allowing for game state manipulation and available moves retrieval.
  * @param timer Allows for termination of the search algorithm after a specified time limit.
  * @param leftDepth The remaining depth of the search.
- * @param alpha The alpha value for alpha-beta pruning from the perspective of the alpha player.
- * @param beta The beta value for alpha-beta pruning from the perspective of the beta player.
+ * @param alpha The lower bound of the alpha-beta window (the score the player to move is already guaranteed).
+ * @param beta The upper bound of the alpha-beta window (the score the opponent is already guaranteed, negated).
  * @return The best move found by the search algorithm and its score.
  */
 std::pair<int, piece_move> Minimax::minimax(Game &game, const Timer& timer, int leftDepth, long long alpha, long long beta)
 {
-    const GameState& gameState = game.getGameState();
-
     long long bestScore = INT32_MIN;
     piece_move bestMove = 0;
-    // Upper bound and lower bound of the possible score for the current state
-    long long upperBound = (gameState.nextBlack ? -beta : -alpha); // Negate beta and alpha because of the different perspective of the other player
-    long long lowerBound = (gameState.nextBlack ? alpha : beta);
+    // Lower bound and upper bound of the possible score for the current state
+    const long long lowerBound = alpha;
+    const long long upperBound = beta;
+    statistics.nodes++;
+    nodesUntilTimeCheck--;
 
     if(leftDepth==0) // Leaf node
     {
-        int score = evaluation.evaluate(gameState);
+        int score = useQuiescence ? quiescence(game, timer, alpha, beta) : evaluation.evaluate(game.getGameState());
         return {score, 0};
     }
 
-    std::span<const piece_move> possibleMovesSpan = gameState.getAvailableMoves();
-    std::vector<piece_move> possibleMoves(possibleMovesSpan.begin(), possibleMovesSpan.end());
+    MoveList possibleMoves = game.getGameState().getAvailableMoves(); // Copy, the game state view is rebuilt after every move
+
+    // Shuffle the root moves to break ties between equally scored moves randomly (the rest of the tree keeps the generator order)
+    if(ply == 0)
+        shuffle(possibleMoves.begin(), possibleMoves.end(), randomEngine);
 
     if(reorderMoves){
-        std::vector<std::pair<int, int>> scores(possibleMoves.size());
-        for(int i = 0; i < possibleMoves.size(); i++){
-            game.makeMove(possibleMoves[i]);
-            scores[i] = {evaluation.evaluate(game.getGameState()), i};
+        std::array<std::pair<int, piece_move>, MAX_MOVES> scores;
+        for(unsigned int i = 0; i < possibleMoves.size(); i++){
+            game.makeMoveUnchecked(possibleMoves[i]);
+            scores[i] = {evaluation.evaluate(game.getGameState()), possibleMoves[i]};
             game.undoMove();
         }
-        std::sort(scores.begin(), scores.end(), [](const std::pair<int, int>& a, const std::pair<int, int>& b){
+        std::sort(scores.begin(), scores.begin() + possibleMoves.size(), [](const std::pair<int, piece_move>& a, const std::pair<int, piece_move>& b){
             return (a.first > b.first);
         });
-        std::vector<piece_move> newMoves(possibleMoves.size());
-        for(int i = 0; i < possibleMoves.size(); i++)
-            newMoves[i] = possibleMoves[scores[i].second];
-        possibleMoves = newMoves;
+        for(unsigned int i = 0; i < possibleMoves.size(); i++)
+            possibleMoves[i] = scores[i].second;
     }
 
-    // Shuffle for random move selection
-    shuffle(possibleMoves.begin(), possibleMoves.end(), randomEngine);
+    // Captures are forced, so a node has either only captures or only quiet moves
+    const bool quietNode = !game.getGameState().hasCapture();
+    if(quietNode && (useKillerMoves || useHistoryHeuristic))
+        orderQuietMoves(possibleMoves, game.isNextBlack());
 
     if(useCache) {
-        const CacheEntry &cacheInfo = cache.get(game.getGameState());
+        const CacheEntry cacheInfo = cache->get(game);
         bestMove = cacheInfo.bestMove;
         if (bestMove != 0) {
             // Move the best found move from the cache to the front of the vector for more efficient search (using alpha-beta pruning)
@@ -68,26 +105,120 @@ std::pair<int, piece_move> Minimax::minimax(Game &game, const Timer& timer, int
             if (it != possibleMoves.end())
                 std::iter_swap(possibleMoves.begin(), it);
         }
-        if (useTranspositionTable && leftDepth == cacheInfo.depth && upperBound == cacheInfo.upperBound && lowerBound == cacheInfo.lowerBound) // Retrieve only if the search parameters match
+        if (useTranspositionTable && leftDepth == cacheInfo.depth && clampScore(upperBound) == cacheInfo.upperBound && clampScore(lowerBound) == cacheInfo.lowerBound) // Retrieve only if the search parameters match
         {
             return {cacheInfo.score, cacheInfo.bestMove};
         }
+        if (useBoundCutoffs && leftDepth == cacheInfo.depth)
+        {
+            // A score which failed high is a lower bound, a score which failed low is an upper bound, a score inside its window is exact
+            const bool failedHigh = cacheInfo.score >= cacheInfo.upperBound;
+            const bool failedLow = cacheInfo.score <= cacheInfo.lowerBound;
+            if((failedHigh && cacheInfo.score >= beta) || (failedLow && cacheInfo.score <= alpha) || (!failedHigh && !failedLow))
+            {
+                statistics.boundCutoffs++;
+                return {cacheInfo.score, cacheInfo.bestMove};
+            }
+        }
     }
 
     if(possibleMoves.empty()) // No moves available = loss
     {
-        return {INT32_MIN+1, 0};
+        return {LOSS_SCORE, 0};
+    }
+
+    // Forward pruning is never done at the root, the bound checks below also skip infinite windows and bounds close to a win or a loss
+    const bool canPrune = useAlphaBeta && ply > 0;
+
+    // ProbCut: if a shallow search beats beta by a margin, the full-depth search would most likely fail high too
+    if(canPrune && useProbCut && leftDepth >= probCutMinDepth && std::abs(beta) < MAX_PRUNING_BOUND)
+    {
+        const long long probCutBeta = beta + probCutMargin;
+        std::pair<int, piece_move> shallow = minimax(game, timer, leftDepth - probCutReduction, probCutBeta - 1, probCutBeta);
+        if(!isStopped(timer) && shallow.first >= probCutBeta)
+        {
+            statistics.probCuts++;
+            return shallow;
+        }
     }
 
+    // The static evaluation of a position with a pending capture is meaningless, only quiet nodes are pruned by it
+    const bool canPruneLow = canPrune && quietNode && std::abs(alpha) < MAX_PRUNING_BOUND;
+    const int razoringMargin = canPruneLow && leftDepth >= 2 && leftDepth < static_cast<int>(razoringMargins.size()) ? razoringMargins[leftDepth] : 0;
+    const int futilityMargin = canPruneLow && leftDepth < static_cast<int>(futilityMargins.size()) ? futilityMargins[leftDepth] : 0;
+    const int staticScore = razoringMargin > 0 || futilityMargin > 0 ? evaluation.evaluate(game.getGameState()) : 0;
+
+    // Razoring: a node far below alpha is unlikely to recover, if a one ply search confirms it, the node fails low
+    if(razoringMargin > 0 && staticScore + razoringMargin <= alpha)
+    {
+        std::pair<int, piece_move> shallow = minimax(game, timer, 1, alpha, alpha + 1);
+        if(!isStopped(timer) && shallow.first <= alpha)
+        {
+            statistics.razorCuts++;
+            return shallow;
+        }
+    }
+
+    // Futility pruning: near the leaves, a quiet move cannot lift a score far below alpha (except for the tactical moves)
+    const bool futileNode = futilityMargin > 0 && staticScore + futilityMargin <= alpha;
+
+    bool firstMove = true;
+    unsigned int moveNumber = 0; // The number of moves searched before the current one
+    const bool reduceMoves = useLateMoveReductions && useAlphaBeta && quietNode; // Captures are never reduced
+    const bool nextBlack = game.isNextBlack();
+    const int kings = reduceMoves || futileNode ? (nextBlack ? game.getBoard().blackKingsCount() : game.getBoard().whiteKingsCount()) : 0;
+    piece_move cutoffMove = 0;
+    ply++;
     for(piece_move nextMove: possibleMoves)
     {
-        if(timer.isFinished())
+        if(isStopped(timer))
             break;
 
-        game.makeMove(nextMove);
+        game.makeMoveUnchecked(nextMove);
+
+        // Promotions are never reduced or pruned
+        const bool promotion = (reduceMoves || futileNode) && (nextBlack ? game.getBoard().blackKingsCount() : game.getBoard().whiteKingsCount()) > kings;
+        if(futileNode && !firstMove && !promotion && !game.getGameState().hasCapture()) // Moves offering a capture (shots) are kept
+        {
+            game.undoMove();
+            statistics.futilityPrunes++;
+            moveNumber++;
+            continue;
+        }
 
-        std::pair<int, piece_move> moveInfo = minimax(game, timer, leftDepth-1, alpha, beta);
-        moveInfo.first *= -1; // Align to the current player's perspective
+        std::pair<int, piece_move> moveInfo;
+        bool fullDepth = true;
+        const int reduction = reduceMoves && !promotion ? getReduction(leftDepth, moveNumber) : 0;
+        if(reduction > 0)
+        {
+            // Late quiet moves rarely beat the earlier ones, prove it with a shallower null-window search first
+            statistics.reductions++;
+            moveInfo = minimax(game, timer, leftDepth-1-reduction, -alpha-1, -alpha);
+            moveInfo.first *= -1;
+            fullDepth = moveInfo.first > alpha; // Otherwise the move is not better than the best one so far
+            if(fullDepth)
+                statistics.reductionResearches++;
+        }
+
+        if(fullDepth && usePvs && useAlphaBeta && !firstMove)
+        {
+            // Only prove that the move is not better than the best one so far, search it fully only if it is
+            moveInfo = minimax(game, timer, leftDepth-1, -alpha-1, -alpha);
+            moveInfo.first *= -1;
+            if(moveInfo.first > alpha && moveInfo.first < beta)
+            {
+                statistics.researches++;
+                moveInfo = minimax(game, timer, leftDepth-1, -beta, -alpha);
+                moveInfo.first *= -1;
+            }
+        }
+        else if(fullDepth)
+        {
+            moveInfo = minimax(game, timer, leftDepth-1, -beta, -alpha);
+            moveInfo.first *= -1; // Align to the current player's perspective
+        }
+        firstMove = false;
+        moveNumber++;
 
         if(moveInfo.first > bestScore)
         {
@@ -99,41 +230,236 @@ std::pair<int, piece_move> Minimax::minimax(Game &game, const Timer& timer, int
 
         if(useAlphaBeta)
         {
-            if(gameState.nextBlack)
-                alpha = std::max(alpha, bestScore);
-            else
-                beta = std::max(beta, bestScore);
-
-            if(-beta <= alpha) // Prune whilst counting with the different perspective
+            alpha = std::max(alpha, bestScore);
+            if(alpha >= beta)
+            {
+                statistics.cutoffs++;
+                if(nextMove == possibleMoves[0])
+                    statistics.firstMoveCutoffs++;
+                cutoffMove = nextMove;
                 break;
+            }
         }
     }
+    ply--;
+    if(quietNode && cutoffMove != 0) // Recorded at the ply of the node, where its killer moves are read
+        updateMoveOrdering(cutoffMove, nextBlack, leftDepth);
 
 
-    if(timer.isFinished()) // If the search was interrupted, return the best move found so far
-        return {INT32_MIN+1, bestMove};
+    if(isStopped(timer)) // If the search was interrupted, return the best move found so far
+        return {LOSS_SCORE, bestMove};
 
     if(useCache)
-        cache.set(gameState, leftDepth, bestScore, upperBound, lowerBound, bestMove);
+        cache->set(game, leftDepth, bestScore, upperBound, lowerBound, bestMove);
 
     return {bestScore, bestMove};
 }
 
+/**
+ * @brief Quiescence search, resolves pending captures before the static evaluation.
+ *
+ * Captures are forced, so a position with a capture cannot be evaluated by standing pat: all its capture sequences are searched
+ * (the search ends because every capture removes a piece). Positions without a capture are evaluated statically.
+ * @param game The game manager class allowing for game state manipulation and available moves retrieval.
+ * @param timer Allows for termination of the search algorithm after a specified time limit.
+ * @param alpha The lower bound of the alpha-beta window.
+ * @param beta The upper bound of the alpha-beta window.
+ * @return The score of the position from the perspective of the player to move.
+ */
+int Minimax::quiescence(Game &game, const Timer& timer, long long alpha, long long beta)
+{
+    statistics.quiescenceNodes++;
+    nodesUntilTimeCheck--;
+    const GameState &gameState = game.getGameState();
+    if(!gameState.hasCapture())
+        return evaluation.evaluate(gameState);
+
+    MoveList captures = gameState.getCaptureMoves(); // Copy, the game state view is rebuilt after every move
+    long long bestScore = LOSS_SCORE;
+    for(piece_move capture: captures)
+    {
+        if(isStopped(timer))
+            break;
+
+        game.makeMoveUnchecked(capture);
+        long long score = -quiescence(game, timer, -beta, -alpha);
+        game.undoMove();
+
+        bestScore = std::max(bestScore, score);
+        if(useAlphaBeta)
+        {
+            alpha = std::max(alpha, bestScore);
+            if(alpha >= beta)
+                break;
+        }
+    }
+    return static_cast<int>(bestScore);
+}
+
+/**
+ * @brief Orders quiet moves by the killer moves of the current ply and by the history heuristic (without making the moves).
+ *
+ * Killer moves go first, the other moves are sorted by their history score. The sort is stable, so ties keep their order.
+ * @param moves The quiet moves of the current node.
+ * @param nextBlack Whether black plays next.
+ */
+void Minimax::orderQuietMoves(MoveList &moves, bool nextBlack)
+{
+    constexpr uint32_t KILLER_PRIORITY = UINT32_MAX;
+    std::array<std::pair<uint32_t, piece_move>, MAX_MOVES> priorities;
+    for(unsigned int i = 0; i < moves.size(); i++)
+    {
+        uint32_t priority = useHistoryHeuristic ? history[nextBlack][moves[i] & 0x1f][historyDirection(moves[i])] : 0;
+        if(useKillerMoves && ply < MAX_SEARCH_PLY)
+        {
+            if(moves[i] == killerMoves[ply][0])
+                priority = KILLER_PRIORITY;
+            else if(moves[i] == killerMoves[ply][1])
+                priority = KILLER_PRIORITY - 1;
+        }
+        priorities[i] = {priority, moves[i]};
+    }
+    std::stable_sort(priorities.begin(), priorities.begin() + moves.size(), [](const std::pair<uint32_t, piece_move>& a, const std::pair<uint32_t, piece_move>& b){
+        return a.first > b.first;
+    });
+    for(unsigned int i = 0; i < moves.size(); i++)
+        moves[i] = priorities[i].second;
+}
+
+/**
+ * @brief Records a quiet move which caused a beta cutoff (as a killer move of the current ply and in the history table).
+ * @param move The move which caused the cutoff.
+ * @param nextBlack Whether black plays the move.
+ * @param leftDepth The remaining depth of the node (deeper cutoffs weigh more).
+ */
+void Minimax::updateMoveOrdering(piece_move move, bool nextBlack, int leftDepth)
+{
+    if(useKillerMoves && ply < MAX_SEARCH_PLY && killerMoves[ply][0] != move)
+    {
+        killerMoves[ply][1] = killerMoves[ply][0];
+        killerMoves[ply][0] = move;
+    }
+    if(useHistoryHeuristic)
+    {
+        uint32_t &score = history[nextBlack][move & 0x1f][historyDirection(move)];
+        score = std::min<uint64_t>(static_cast<uint64_t>(score) + leftDepth * leftDepth, UINT32_MAX - 2); // Stays below the killer priorities
+    }
+}
+
+/**
+ * @brief Returns the late move reduction of a quiet move, a reduced move is still searched at least one ply deep.
+ * @param leftDepth The remaining depth of the node.
+ * @param moveNumber The number of moves searched before the move.
+ */
+int Minimax::getReduction(int leftDepth, unsigned int moveNumber) const
+{
+    return std::min<int>(lateMoveReductions[std::min(leftDepth, MAX_SEARCH_PLY - 1)][std::min(moveNumber, MAX_MOVES - 1)], leftDepth - 2);
+}
+
+/**
+ * @brief Prepares the move ordering for a search from a new root (clears the killer moves and ages the history scores).
+ */
+void Minimax::prepareSearch()
+{
+    ply = 0;
+    stopped = false;
+    nodesUntilTimeCheck = 0;
+    for(auto &killers : killerMoves)
+        killers = {0, 0};
+    for(auto &side : history)
+        for(auto &square : side)
+            for(uint32_t &score : square)
+                score /= 2;
+}
+
+/**
+ * @brief Searches a node below the root of another search (the parallel search), so the ply dependent heuristics see its real distance from the root.
+ *
+ * The root move shuffle and the pruning disabled at the root apply only at ply 0, the killer moves are stored per ply.
+ * @param game The game in the position of the node.
+ * @param timer Allows for termination of the search algorithm after a specified time limit.
+ * @param nodePly The distance of the node from the root.
+ * @param leftDepth The remaining depth of the search.
+ * @param alpha The lower bound of the alpha-beta window.
+ * @param beta The upper bound of the alpha-beta window.
+ * @return The best move found by the search algorithm and its score.
+ */
+std::pair<int, piece_move> Minimax::searchNode(Game &game, const Timer& timer, int nodePly, int leftDepth, long long alpha, long long beta)
+{
+    ply = nodePly;
+    std::pair<int, piece_move> result = minimax(game, timer, leftDepth, alpha, beta);
+    ply = 0;
+    return result;
+}
+
 std::pair<int, piece_move> Minimax::findBestMove(Game &game, const Timer& timer)
 {
+    prepareSearch();
     Timer localTimer = Timer(std::min(moveTimeLimit, timer.getRemainingTime()));
     return minimax(game, localTimer, maxDepth);
 }
 
+std::shared_ptr<Cache<>> Minimax::getCache() const
+{
+    return cache;
+}
+
+void Minimax::setStopSignal(const std::atomic<bool> *signal)
+{
+    stopSignal = signal;
+}
+
+/**
+ * @brief Returns the best move of the position stored in the cache (the principal variation of the last search continues with it).
+ * @param game The position.
+ * @return The best move, or 0 if the position is not cached or the cache is disabled.
+ */
+piece_move Minimax::getExpectedMove(Game &game)
+{
+    if(!useCache)
+        return 0;
+    const piece_move move = cache->get(game).bestMove;
+    const MoveList &moves = game.getGameState().getAvailableMoves();
+    return std::find(moves.begin(), moves.end(), move) != moves.end() ? move : 0; // A hash collision can yield an illegal move
+}
+
+bool Minimax::wasStopped() const
+{
+    return stopped;
+}
+
+const std::array<piece_move, 2>& Minimax::getKillerMoves(int killerPly) const
+{
+    return killerMoves[killerPly];
+}
+
 void Minimax::setMaxDepth(int newDepth)
 {
     maxDepth = newDepth;
 }
 
+const SearchStatistics& Minimax::getStatistics() const
+{
+    return statistics;
+}
+
+void Minimax::resetStatistics()
+{
+    statistics = SearchStatistics();
+}
+
 IterativeMinimax::IterativeMinimax(Hyperparameters &hyperparameters, Evaluation &eval)
-        : minimax(hyperparameters, eval), maxDepth(hyperparameters.get<int>(MAX_DEPTH_ID)),
-        moveTimeLimit(hyperparameters.get<long long>(MOVE_TIME_LIMIT_ID))
+        : minimax(hyperparameters, eval), maxDepth(hyperparameters.get<int>(MAX_DEPTH_ID)), timeManager(hyperparameters),
+        aspirationWindow(hyperparameters.get<int>(ASPIRATION_WINDOW_ID)),
+        aspirationWidening(std::max(hyperparameters.get<int>(ASPIRATION_WIDENING_ID), 2))
 {
+    const int threads = std::max(hyperparameters.get<int>(THREADS_ID), 1);
+    for(int i = 1; i < threads; i++)
+    {
+        // Different seeds shuffle the root moves differently, so the helpers do not all search the same subtrees first
+        helpers.push_back(std::make_unique<Minimax>(hyperparameters, eval, minimax.getCache(), i));
+        helpers.back()->setStopSignal(&stopSignal);
+    }
 }
 
 /**
@@ -144,40 +470,253 @@ IterativeMinimax::IterativeMinimax(Hyperparameters &hyperparameters, Evaluation
  */
 std::pair<int, piece_move> IterativeMinimax::findBestMove(Game &game, const Timer& timer)
 {
-    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    const GameState& gameState = game.getGameState();
+
+    std::pair<int, piece_move> bestMove;
+    bestMove.first = LOSS_SCORE;
+    bestMove.second = gameState.getAvailableMoves()[0];
+
+    timeManager.startMove(gameState, timer.getRemainingTime());
+    Timer localTimer = Timer(timeManager.getMaximumTime());
+    localTimer.resume();
+
+    iterationStatistics.clear();
+    minimax.prepareSearch();
+
+    stopSignal = false;
+    std::vector<std::thread> helperThreads;
+    for(unsigned int i = 0; i < helpers.size(); i++)
+        helperThreads.emplace_back(&IterativeMinimax::runHelper, this, std::ref(*helpers[i]), game, std::cref(localTimer), 1 + (i % 2 == 0));
+    for(int i = 1; i <= maxDepth; ++i)
+    {
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        minimax.resetStatistics();
+        unsigned int aspirationFails = 0;
+
+        std::pair<int, piece_move> candidate = searchIteration(game, localTimer, i, i > 1 ? std::optional<int>(bestMove.first) : std::nullopt, aspirationFails);
+
+        SearchStatistics statistics = minimax.getStatistics();
+        statistics.aspirationFails = aspirationFails;
+        const long long microseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+        statistics.milliseconds = microseconds / 1000;
+        iterationStatistics.push_back(statistics);
+
+        if(candidate.second != 0 && !minimax.wasStopped())
+        {
+            bestMove = candidate;
+            timeManager.recordIteration(i, bestMove.second, bestMove.first, microseconds);
+        }
+
+        if(bestMove.first==WIN_SCORE || candidate.second == 0 || minimax.wasStopped()) // If winning path was found or the search was interrupted, end
+        {
+            break;
+        }
+        if(i < maxDepth && !timeManager.shouldStartIteration()) // The next iteration is not expected to pay off
+        {
+            break;
+        }
+    }
+
+    stopSignal = true;
+    for(std::thread &thread : helperThreads)
+        thread.join();
+    timeManager.finishMove(minimax.wasStopped());
+
+    return bestMove;
+}
+
+/**
+ * @brief Iterative deepening of a helper thread of the Lazy SMP search, its results reach the main thread only through the shared cache.
+ * @param helper The search of the helper thread.
+ * @param game A copy of the searched game (owned by the thread).
+ * @param timer The timer of the main search.
+ * @param firstDepth The depth of the first iteration (staggers the depths searched by the threads).
+ */
+void IterativeMinimax::runHelper(Minimax &helper, Game game, const Timer& timer, int firstDepth)
+{
+    helper.prepareSearch();
+    for(int depth = firstDepth; depth <= maxDepth && !stopSignal.load(std::memory_order_relaxed) && !timer.isFinished(); depth++)
+        helper.minimax(game, timer, depth);
+}
+
+/**
+ * @brief Searches one iteration, within an aspiration window around the score of the previous iteration if enabled.
+ *
+ * If the score falls outside of the window, the window is widened on the failed side (its distance from the previous score
+ * is multiplied by aspirationWidening) and the depth is searched again, until the score lies inside the window.
+ * @param game The game manager class allowing for game state manipulation and available moves retrieval.
+ * @param timer Allows for termination of the search algorithm after a specified time limit.
+ * @param depth The depth of the iteration.
+ * @param previousScore The score of the previous iteration (none for the first iteration).
+ * @param aspirationFails Incremented on every search which falls outside of the window.
+ * @return The best move found by the search algorithm and its score.
+ */
+std::pair<int, piece_move> IterativeMinimax::searchIteration(Game &game, const Timer& timer, int depth, std::optional<int> previousScore, unsigned int &aspirationFails)
+{
+    if(aspirationWindow <= 0 || !previousScore || *previousScore == WIN_SCORE || *previousScore == LOSS_SCORE)
+        return minimax.minimax(game, timer, depth);
+
+    long long lowerDistance = aspirationWindow;
+    long long upperDistance = aspirationWindow;
+    while(true)
+    {
+        long long alpha = std::max<long long>(*previousScore - lowerDistance, INT32_MIN);
+        long long beta = std::min<long long>(*previousScore + upperDistance, INT32_MAX);
+        std::pair<int, piece_move> candidate = minimax.minimax(game, timer, depth, alpha, beta);
+        if(minimax.wasStopped())
+            return candidate;
+
+        if(candidate.first <= alpha && alpha > INT32_MIN) // Fail low, the score is at most alpha
+            lowerDistance *= aspirationWidening;
+        else if(candidate.first >= beta && beta < INT32_MAX) // Fail high, the score is at least beta
+            upperDistance *= aspirationWidening;
+        else
+            return candidate;
+        aspirationFails++;
+    }
+}
+
+void IterativeMinimax::setStopSignal(const std::atomic<bool> *signal)
+{
+    minimax.setStopSignal(signal);
+}
+
+piece_move IterativeMinimax::getExpectedMove(Game &game)
+{
+    return minimax.getExpectedMove(game);
+}
+
+const std::vector<SearchStatistics>& IterativeMinimax::getIterationStatistics() const
+{
+    return iterationStatistics;
+}
+
+MtdfMinimax::MtdfMinimax(Hyperparameters &hyperparameters, Evaluation &eval)
+        : minimax(hyperparameters, eval), evaluation(eval), maxDepth(hyperparameters.get<int>(MAX_DEPTH_ID)), timeManager(hyperparameters)
+{
+}
 
+/**
+ * @brief Iterative deepening MTD(f) search algorithm, each iteration starts from the score of the previous one.
+ * @param game The game manager class allowing for game state manipulation and available moves retrieval.
+ * @param timer Allows for termination of the search algorithm after a specified time limit.
+ * @return The best move found by the search algorithm and its score.
+ */
+std::pair<int, piece_move> MtdfMinimax::findBestMove(Game &game, const Timer& timer)
+{
     const GameState& gameState = game.getGameState();
 
     std::pair<int, piece_move> bestMove;
-    bestMove.first = INT32_MIN;
+    bestMove.first = LOSS_SCORE;
     bestMove.second = gameState.getAvailableMoves()[0];
 
-    Timer localTimer = Timer(std::min(moveTimeLimit, timer.getRemainingTime()/4));
+    timeManager.startMove(gameState, timer.getRemainingTime());
+    Timer localTimer = Timer(timeManager.getMaximumTime());
     localTimer.resume();
 
+    iterationStatistics.clear();
+    minimax.prepareSearch();
+
+    int guess = evaluation.evaluate(gameState); // The first guess of the first iteration
     for(int i = 1; i <= maxDepth; ++i)
     {
-        std::pair<int, piece_move> candidate = minimax.minimax(game, localTimer, i);
-        if(candidate.second != 0 && !localTimer.isFinished())
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        minimax.resetStatistics();
+        uint64_t probes = 0;
+
+        std::pair<int, piece_move> candidate = mtdf(game, localTimer, i, guess, probes);
+
+        SearchStatistics statistics = minimax.getStatistics();
+        statistics.probes = probes;
+        const long long microseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+        statistics.milliseconds = microseconds / 1000;
+        iterationStatistics.push_back(statistics);
+
+        if(candidate.second != 0 && !minimax.wasStopped())
+        {
             bestMove = candidate;
+            guess = candidate.first;
+            timeManager.recordIteration(i, bestMove.second, bestMove.first, microseconds);
+        }
 
-        if(bestMove.first==INT32_MAX || candidate.second == 0 || localTimer.isFinished()) // If winning path was found or the search was interrupted, end
+        if(bestMove.first==WIN_SCORE || candidate.second == 0 || minimax.wasStopped()) // If winning path was found or the search was interrupted, end
+        {
+            break;
+        }
+        if(i < maxDepth && !timeManager.shouldStartIteration()) // The next iteration is not expected to pay off
         {
             break;
         }
     }
+    timeManager.finishMove(minimax.wasStopped());
 
     return bestMove;
 }
 
+/**
+ * @brief Finds the minimax value of the root by null-window searches until its lower and upper bound meet.
+ *
+ * The best move is taken from the last probe which failed high (it proved the move reaches the lower bound),
+ * a probe failing low only proves that no move reaches its window.
+ * @param game The game manager class allowing for game state manipulation and available moves retrieval.
+ * @param timer Allows for termination of the search algorithm after a specified time limit.
+ * @param depth The depth of the search.
+ * @param firstGuess The expected value (the closer, the fewer probes).
+ * @param probes Incremented on every probe.
+ * @return The best move and the value (the move is 0 if the search was stopped before the first probe ended).
+ */
+std::pair<int, piece_move> MtdfMinimax::mtdf(Game &game, const Timer& timer, int depth, int firstGuess, uint64_t &probes)
+{
+    long long lowerBound = LOSS_SCORE;
+    long long upperBound = WIN_SCORE;
+    long long guess = std::clamp<long long>(firstGuess, LOSS_SCORE, WIN_SCORE);
+    piece_move bestMove = 0;
+    piece_move lastMove = 0;
+    while(lowerBound < upperBound)
+    {
+        const long long beta = guess == lowerBound ? guess + 1 : guess;
+        std::pair<int, piece_move> probe = minimax.minimax(game, timer, depth, beta - 1, beta);
+        if(minimax.wasStopped())
+            break;
+        probes++;
+        guess = probe.first;
+        lastMove = probe.second;
+        if(guess < beta)
+            upperBound = guess;
+        else
+        {
+            lowerBound = guess;
+            bestMove = probe.second;
+        }
+    }
+    if(bestMove == 0) // Every probe failed low (the root is lost) or the search was stopped
+        bestMove = lastMove;
+    return {static_cast<int>(guess), bestMove};
+}
+
+void MtdfMinimax::setStopSignal(const std::atomic<bool> *signal)
+{
+    minimax.setStopSignal(signal);
+}
+
+piece_move MtdfMinimax::getExpectedMove(Game &game)
+{
+    return minimax.getExpectedMove(game);
+}
+
+const std::vector<SearchStatistics>& MtdfMinimax::getIterationStatistics() const
+{
+    return iterationStatistics;
+}
+
 RandomSearch::RandomSearch() = default;
 
 std::pair<int, piece_move> RandomSearch::findBestMove(Game &game, const Timer& timer)
 {
     const GameState& gameState = game.getGameState();
-    std::span<const piece_move> possibleMoves = gameState.getAvailableMoves();
+    const MoveList& possibleMoves = gameState.getAvailableMoves();
     if(possibleMoves.empty())
-        return {INT32_MIN, 0};
+        return {LOSS_SCORE, 0};
 
     // Generate random move
     std::random_device rd;
@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <format>
+#include <iostream>
+
+#include "includes/time_manager.hpp"
+
+TimeManager::TimeManager(Hyperparameters &hyperparameters)
+        : movesToGo(std::max(hyperparameters.get<int>(TIME_MOVES_TO_GO_ID), MIN_MOVES_TO_GO)),
+        maxTimeFactor(std::max(hyperparameters.get<int>(TIME_MAX_FACTOR_ID), 1)),
+        stableIterations(hyperparameters.get<int>(TIME_STABLE_ITERATIONS_ID)), scoreDrop(hyperparameters.get<int>(TIME_SCORE_DROP_ID)),
+        logTimeUsage(hyperparameters.get<bool>(LOG_TIME_USAGE_ID)), moveTimeLimit(hyperparameters.get<long long>(MOVE_TIME_LIMIT_ID))
+{
+}
+
+/**
+ * @brief Computes the optimum and the maximum time of a move.
+ *
+ * Fewer pieces mean fewer moves left, so the expected number of moves shrinks with the material (but stays at least MIN_MOVES_TO_GO).
+ * The maximum time never exceeds a quarter of the remaining time, so the clock cannot run out.
+ * @param gameState The position to search.
+ * @param remainingTime The remaining time of the player in milliseconds.
+ */
+void TimeManager::startMove(const GameState &gameState, long long remainingTime)
+{
+    start = std::chrono::steady_clock::now();
+    const int pieces = gameState.board.allPiecesCount();
+    expectedMoves = std::max(MIN_MOVES_TO_GO, movesToGo * pieces / 24);
+
+    const long long remaining = std::max(remainingTime, 0ll) * 1000;
+    maximumTime = std::min({moveTimeLimit * 1000, remaining / 4, remaining / expectedMoves * maxTimeFactor});
+    optimumTime = std::min(remaining / expectedMoves, maximumTime);
+
+    lastIterationTime = previousIterationTime = 0;
+    depth = 0;
+    bestMove = 0;
+    bestMoveStability = 0;
+    scoreDropped = false;
+    stopReason = "depth limit";
+}
+
+long long TimeManager::getMaximumTime() const
+{
+    return maximumTime / 1000;
+}
+
+long long TimeManager::getElapsedTime() const
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Records a finished iteration (its best move, its score and its duration).
+ * @param iterationDepth The depth of the iteration.
+ * @param iterationBestMove The best move found by the iteration.
+ * @param score The score of the best move.
+ * @param microseconds The duration of the iteration.
+ */
+void TimeManager::recordIteration(int iterationDepth, piece_move iterationBestMove, int score, long long microseconds)
+{
+    if(depth > 0)
+    {
+        bestMoveStability = iterationBestMove == bestMove ? bestMoveStability + 1 : 0;
+        if(scoreDrop > 0 && score <= static_cast<long long>(lastScore) - scoreDrop)
+            scoreDropped = true;
+    }
+    depth = iterationDepth;
+    bestMove = iterationBestMove;
+    lastScore = score;
+    previousIterationTime = lastIterationTime;
+    lastIterationTime = microseconds;
+}
+
+long long TimeManager::getTargetTime() const
+{
+    long long target = optimumTime;
+    if(stableIterations > 0 && bestMoveStability >= stableIterations)
+        target /= 2;
+    if(scoreDropped)
+        target *= 2;
+    return std::min(target, maximumTime);
+}
+
+/**
+ * @brief Decides whether to start the next iteration.
+ *
+ * The duration of the next iteration is predicted as the duration of the last one times the effective branching factor
+ * (the ratio of the durations of the last two iterations). An iteration which is not expected to finish by the target time is not started,
+ * an unfinished iteration would be thrown away.
+ * @return Whether the next iteration should be searched.
+ */
+bool TimeManager::shouldStartIteration()
+{
+    const long long elapsed = getElapsedTime();
+    const long long target = getTargetTime();
+    if(elapsed >= target)
+    {
+        stopReason = "target time";
+        return false;
+    }
+    const double branchingFactor = previousIterationTime > 0 ? std::max(static_cast<double>(lastIterationTime) / static_cast<double>(previousIterationTime), 1.0) : 1.0;
+    if(static_cast<double>(elapsed) + static_cast<double>(lastIterationTime) * branchingFactor > static_cast<double>(target))
+    {
+        stopReason = "predicted iteration";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Prints the time usage of the move to the standard error output (the standard output may be used by the console interface)
+ * @param interrupted Whether the search was stopped by the timer or the stop signal.
+ */
+void TimeManager::finishMove(bool interrupted)
+{
+    if(!logTimeUsage)
+        return;
+    std::cerr << std::format("time: {} moves to go, optimum {}ms, target {}ms, maximum {}ms, used {}ms, depth {}, stable {}, score {}{}, stopped by {}\n",
+                             expectedMoves, optimumTime / 1000, getTargetTime() / 1000, maximumTime / 1000, getElapsedTime() / 1000, depth,
+                             bestMoveStability, lastScore, scoreDropped ? " (dropped)" : "", interrupted ? "timer" : stopReason);
+}
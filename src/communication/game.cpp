@@ -1,4 +1,7 @@
 #include "includes/game.hpp"
+#include "includes/board_tables.hpp"
+#include "includes/zobrist.hpp"
+#include <algorithm>
 #include <sstream>
 #include <format>
 
@@ -10,23 +13,6 @@ Pos::Pos(unsigned int index){
     x += ((y % 2)==0);
 }
 
-// Return neighboring cells
-constexpr inline unsigned int tl(unsigned int index){
-    return index - 4 - ((index >> 2) & 1);
-}
-constexpr inline unsigned int tr(unsigned int index){
-    return index - 3 - ((index >> 2) & 1);
-}
-constexpr inline unsigned int bl(unsigned int index){
-    return index + 4 - ((index >> 2) & 1);
-}
-constexpr inline unsigned int br(unsigned int index){
-    return index + 5 - ((index >> 2) & 1);
-}
-constexpr inline unsigned int king_row(unsigned int index){
-    return index < 4;
-}
-
 void visualize_bitboard(bitboard_all bitboard){
     for(int i = 0; i<8; i++){
         for(int j = 0; j<4; j++){
@@ -274,65 +260,133 @@ std::ostream& operator<<(std::ostream& os, const Move& move){
     return os;
 }
 
-GameState::GameState(Board board, bool nextBlack)
-        : board(board), nextBlack(nextBlack) {
-    calculateAvailableMoves();
+MoveList::MoveList(const MoveList& other) : count(other.count) {
+    std::copy(other.begin(), other.end(), moves.begin());
+}
+
+MoveList& MoveList::operator=(const MoveList& other) {
+    count = other.count;
+    std::copy(other.begin(), other.end(), moves.begin());
+    return *this;
+}
+
+/**
+ * @brief Appends a move in the given direction for every piece in the movers bitboard
+ * @param moves The list to append to
+ * @param movers The bitboard of the pieces that can move in the direction (absolute squares)
+ * @param direction The direction of the move (from the perspective of the player to move)
+ * @param black Whether black moves (the squares are mirrored)
+ */
+inline void addQuietMoves(MoveList &moves, bitboard movers, Direction direction, bool black){
+    while(movers){
+        unsigned int index = __builtin_ctz(movers) ^ SIDE_SQUARE_MIRROR[black];
+        moves.push_back(index | (direction << 5));
+        movers &= movers - 1;
+    }
 }
 
+/**
+ * @brief Calculates the pieces able to make a single jump in each direction at once
+ * @param pieces The pieces that can jump forward
+ * @param backwardPieces The pieces that can also jump backward (kings)
+ * @param enemyPieces The pieces that can be captured
+ * @param empty The empty squares
+ * @tparam black Whether black moves (forward is to the bottom of the board)
+ * @return The bitboard of the pieces that can jump
+ */
+template<bool black>
+inline bitboard getJumpers(bitboard pieces, bitboard backwardPieces, bitboard enemyPieces, bitboard empty){
+    bitboard upPieces = black ? backwardPieces : pieces;
+    bitboard downPieces = black ? pieces : backwardPieces;
+    bitboard jumpers = upPieces & withNeighborIn<Direction::topLeft>(enemyPieces) & withLandingIn<Direction::topLeft>(empty);
+    jumpers |= upPieces & withNeighborIn<Direction::topRight>(enemyPieces) & withLandingIn<Direction::topRight>(empty);
+    jumpers |= downPieces & withNeighborIn<Direction::bottomLeft>(enemyPieces) & withLandingIn<Direction::bottomLeft>(empty);
+    jumpers |= downPieces & withNeighborIn<Direction::bottomRight>(enemyPieces) & withLandingIn<Direction::bottomRight>(empty);
+    return jumpers;
+}
+
+/**
+ * @brief Returns whether any of the pieces can make a step
+ * @tparam black Whether black moves (forward is to the bottom of the board)
+ */
+template<bool black>
+inline bool anyMovers(bitboard pieces, bitboard kings, bitboard empty){
+    bitboard upPieces = black ? kings : pieces;
+    bitboard downPieces = black ? pieces : kings;
+    bitboard movers = upPieces & (withNeighborIn<Direction::topLeft>(empty) | withNeighborIn<Direction::topRight>(empty));
+    movers |= downPieces & (withNeighborIn<Direction::bottomLeft>(empty) | withNeighborIn<Direction::bottomRight>(empty));
+    return movers != 0;
+}
+
+GameState::GameState(Board board, bool nextBlack)
+        : board(board), nextBlack(nextBlack) {}
+
 Board GameState::getPerspectiveBoard() const {
     return nextBlack ? board.getBoardRev() : board;
 }
 
-std::span<const piece_move> GameState::getAvailableMoves() const {
-    return {availableMoves};
+const MoveList& GameState::getAvailableMoves() const {
+    if(!movesCalculated)
+        calculateAvailableMoves();
+    return availableMoves;
+}
+
+/**
+ * @brief Returns whether the current player has any legal move
+ *
+ * Does not generate the moves, only checks whether any piece can jump or move (using the same masks as calculateAvailableMoves).
+ */
+bool GameState::hasAnyMove() const {
+    if(movesCalculated)
+        return !availableMoves.empty();
+
+    bitboard_all controlBitboard = nextBlack ? board.blackBitboard : board.whiteBitboard;
+    bitboard_all enemyBitboard = nextBlack ? board.whiteBitboard : board.blackBitboard;
+    bitboard controlPieces = controlBitboard&0xffffffff;
+    bitboard controlKings = controlBitboard>>32;
+    bitboard enemyPieces = enemyBitboard&0xffffffff;
+    bitboard empty = ~(controlPieces | enemyPieces);
+    bitboard backwardPieces = controlKings | (controlPieces & PROMOTION_ROW[nextBlack]); // Pawns standing on the promotion row jump as kings
+
+    if(nextBlack)
+        return getJumpers<true>(controlPieces, backwardPieces, enemyPieces, empty) || anyMovers<true>(controlPieces, controlKings, empty);
+    return getJumpers<false>(controlPieces, backwardPieces, enemyPieces, empty) || anyMovers<false>(controlPieces, controlKings, empty);
+}
+
+zobrist_key GameState::getHash() const {
+    zobrist_key hash = zobristDelta(0, board.whiteBitboard, false) ^ zobristDelta(0, board.blackBitboard, true);
+    return nextBlack ? hash ^ ZOBRIST_KEYS.blackToMove : hash;
 }
 
 Move GameState::getMove(piece_move pieceMove) const {
-    unsigned int currentPos = pieceMove & 0x1f;
+    unsigned int currentPos = (pieceMove & 0x1f) ^ SIDE_SQUARE_MIRROR[nextBlack];
 
     Move move{pieceMove, {Pos(currentPos)}, nextBlack};
 
     pieceMove >>= 5;
-    Board perspectiveBoard = getPerspectiveBoard();
-    bitboard_all controlBitboard = perspectiveBoard.whiteBitboard;
-    bitboard_all enemyBitboard = perspectiveBoard.blackBitboard;
+    bitboard enemyPieces = (nextBlack ? board.whiteBitboard : board.blackBitboard) & 0xffffffff;
 
     while (pieceMove) { // TODO: MERGE THIS WITH MAKE_MOVE
-        unsigned int direction = pieceMove & 0x7;
-        unsigned int startPos = currentPos;
-        for(int i = 0; i<2; i++){
-            if (direction == Direction::topLeft)
-                currentPos = tl(currentPos);
-            else if (direction == Direction::topRight)
-                currentPos = tr(currentPos);
-            else if (direction == Direction::bottomLeft)
-                currentPos = bl(currentPos);
-            else
-                currentPos = br(currentPos);
-            if(enemyBitboard & (1ll<<currentPos))
-                enemyBitboard &= (~((1ll<<currentPos) | (1ll<<(currentPos+32))));
-            else
-                break;
+        unsigned int direction = ((pieceMove & 0x7) - 1) ^ SIDE_DIRECTION_MIRROR[nextBlack];
+        unsigned int neighbor = BOARD_TABLES.neighbor[currentPos][direction];
+        if(enemyPieces & BOARD_TABLES.squareBit[neighbor]){ // Jump
+            enemyPieces &= ~BOARD_TABLES.squareBit[neighbor];
+            currentPos = BOARD_TABLES.landing[currentPos][direction];
         }
+        else
+            currentPos = neighbor;
 
         move.path.emplace_back(currentPos);
 
         pieceMove >>= 3;
     }
 
-    if(nextBlack){
-        // Adjust for board orientation
-        for(auto& pos : move.path){
-            pos = Pos(31-pos.indexFromPos());
-        }
-    }
-
     return move;
 }
 
 std::vector<Move> GameState::getAvailableMoves2() const {
     std::vector<Move> moves;
-    for (auto pieceMove: availableMoves)
+    for (auto pieceMove: getAvailableMoves())
     {
         Move move = getMove(pieceMove);
 
@@ -341,30 +395,20 @@ std::vector<Move> GameState::getAvailableMoves2() const {
     return moves;
 }
 
-void GameState::searchMoves(piece_move currentMove, unsigned int jumpCount, position lastPos, bitboard curEnemyPieces, bool isKing, bitboard controlPieces)
+void GameState::searchMoves(piece_move currentMove, unsigned int jumpCount, position lastPos, bitboard curEnemyPieces, bool isKing, bitboard controlPieces) const
 {
         bool anyJumps = false;
-        isKing |= king_row(lastPos);
-        bitboard anyPieces = controlPieces | curEnemyPieces;
-        // Jump top-left
-        if(lastPos > 7 && lastPos % 4 != 0 && (curEnemyPieces&(1<<(tl(lastPos))) && (anyPieces&(1<<(tl(tl(lastPos))))) == 0)){
-            searchMoves(currentMove | (1<<(jumpCount*3 + 5)), jumpCount+1, tl(tl(lastPos)), curEnemyPieces^(1<<(tl(lastPos))), isKing, controlPieces);
-            anyJumps = true;
-        }
-        // Jump top-right
-        if(lastPos > 7 && lastPos % 4 != 3 && (curEnemyPieces&(1<<(tr(lastPos))) && (anyPieces&(1<<(tr(tr(lastPos))))) == 0)){
-            searchMoves(currentMove | (2<<(jumpCount*3 + 5)), jumpCount+1, tr(tr(lastPos)), curEnemyPieces^(1<<(tr(lastPos))), isKing, controlPieces);
-            anyJumps = true;
-        }
-        // Jump bottom-left
-        if(isKing && lastPos < 24 && lastPos % 4 != 0 && (curEnemyPieces&(1<<(bl(lastPos))) && (anyPieces&(1<<bl(bl(lastPos)))) == 0)){
-            searchMoves(currentMove | (3<<(jumpCount*3 + 5)), jumpCount+1, bl(bl(lastPos)), curEnemyPieces^(1<<(bl(lastPos))), isKing, controlPieces);
-            anyJumps = true;
-        }
-        // Jump bottom-right
-        if(isKing && lastPos < 24 && lastPos % 4 != 3 && (curEnemyPieces&(1<<br(lastPos)) && (anyPieces&(1<<br(br(lastPos)))) == 0)){
-            searchMoves(currentMove | (4<<(jumpCount*3 + 5)), jumpCount+1, br(br(lastPos)), curEnemyPieces^(1<<br(lastPos)), isKing, controlPieces);
-            anyJumps = true;
+        isKing |= (PROMOTION_ROW[nextBlack] & BOARD_TABLES.squareBit[lastPos]) != 0;
+        bitboard empty = ~(controlPieces | curEnemyPieces);
+        unsigned int directions = isKing ? NUM_DIRECTIONS : 2; // Pawns only jump forward (top-left, top-right from their perspective)
+        for(unsigned int direction = 0; direction < directions; direction++){
+            unsigned int absoluteDirection = direction ^ SIDE_DIRECTION_MIRROR[nextBlack];
+            unsigned int jumpedOver = BOARD_TABLES.neighbor[lastPos][absoluteDirection];
+            unsigned int landing = BOARD_TABLES.landing[lastPos][absoluteDirection];
+            if((curEnemyPieces & BOARD_TABLES.squareBit[jumpedOver]) && (empty & BOARD_TABLES.squareBit[landing])){
+                searchMoves(currentMove | (static_cast<piece_move>(direction + 1) << (jumpCount*3 + 5)), jumpCount+1, landing, curEnemyPieces^BOARD_TABLES.squareBit[jumpedOver], isKing, controlPieces);
+                anyJumps = true;
+            }
         }
 
         if(!anyJumps&&jumpCount>0){
@@ -372,93 +416,174 @@ void GameState::searchMoves(piece_move currentMove, unsigned int jumpCount, posi
         }
 };
 
-void GameState::calculateAvailableMoves() {
+/**
+ * @brief Returns whether the current player has a capture (and therefore has to capture) without generating the moves
+ */
+bool GameState::hasCapture() const {
+    bitboard_all controlBitboard = nextBlack ? board.blackBitboard : board.whiteBitboard;
+    bitboard_all enemyBitboard = nextBlack ? board.whiteBitboard : board.blackBitboard;
+    bitboard controlPieces = controlBitboard&0xffffffff;
+    bitboard controlKings = controlBitboard>>32;
+    bitboard enemyPieces = enemyBitboard&0xffffffff;
+    bitboard empty = ~(controlPieces | enemyPieces);
+    bitboard backwardPieces = controlKings | (controlPieces & PROMOTION_ROW[nextBlack]);
+
+    if(nextBlack)
+        return getJumpers<true>(controlPieces, backwardPieces, enemyPieces, empty) != 0;
+    return getJumpers<false>(controlPieces, backwardPieces, enemyPieces, empty) != 0;
+}
+
+/**
+ * @brief Returns the capture moves of the current player (empty if the player cannot capture)
+ *
+ * Captures are forced, so if there are any they are exactly the available moves, and only the capture generator runs to find them.
+ */
+const MoveList& GameState::getCaptureMoves() const {
+    static const MoveList noMoves{};
+    if(movesCalculated)
+        return hasCapture() ? availableMoves : noMoves;
+
+    availableMoves.clear();
+    calculateCaptureMoves();
+    if(availableMoves.empty())
+        return noMoves;
+    movesCalculated = true; // The captures are all the available moves
+    return availableMoves;
+}
+
+/**
+ * @brief Finds the available moves for the current player
+ *
+ * The movers and jumpers of all pieces are computed at once with shifted masks of the whole bitboard.
+ * Individual pieces are expanded only when building the final moves (jump sequences are then followed by searchMoves).
+ * Jumps are forced and jumps of kings take precedence over jumps of pawns.
+ * Moves are generated on the absolute board (black uses mirrored directions), so the bitboards are never reversed.
+ */
+void GameState::calculateAvailableMoves() const {
     availableMoves.clear();
+    movesCalculated = true;
 
-    Board boards = getPerspectiveBoard();
-    bitboard_all controlBitboard = boards.whiteBitboard; // The bitboard_all of the pieces that can move next
-    bitboard_all enemyBitboard = boards.blackBitboard; // The bitboard_all of the pieces that can be captured
+    calculateCaptureMoves();
+    if(!availableMoves.empty())
+        return;
 
+    bitboard_all controlBitboard = nextBlack ? board.blackBitboard : board.whiteBitboard;
+    bitboard_all enemyBitboard = nextBlack ? board.whiteBitboard : board.blackBitboard;
     bitboard controlPieces = controlBitboard&0xffffffff;
     bitboard controlKings = controlBitboard>>32;
     bitboard enemyPieces = enemyBitboard&0xffffffff;
+    bitboard empty = ~(controlPieces | enemyPieces);
 
-    for(int i = 0; i < BOARD_SIZE; i++){
-        if(controlKings&(1<<i))
-        {
-            searchMoves(i, 0, i, enemyPieces, true, controlPieces);
-        }
-    }
-    if(!availableMoves.empty())
-        return;
+    bitboard upPieces = nextBlack ? controlKings : controlPieces;
+    bitboard downPieces = nextBlack ? controlPieces : controlKings;
+    addQuietMoves(availableMoves, upPieces & withNeighborIn<Direction::topLeft>(empty), nextBlack ? Direction::bottomRight : Direction::topLeft, nextBlack);
+    addQuietMoves(availableMoves, upPieces & withNeighborIn<Direction::topRight>(empty), nextBlack ? Direction::bottomLeft : Direction::topRight, nextBlack);
+    addQuietMoves(availableMoves, downPieces & withNeighborIn<Direction::bottomLeft>(empty), nextBlack ? Direction::topRight : Direction::bottomLeft, nextBlack);
+    addQuietMoves(availableMoves, downPieces & withNeighborIn<Direction::bottomRight>(empty), nextBlack ? Direction::topLeft : Direction::bottomRight, nextBlack);
+}
 
+/**
+ * @brief Appends the capture moves of the current player to the available moves (jumps of kings take precedence over jumps of pawns)
+ */
+void GameState::calculateCaptureMoves() const {
+    bitboard_all controlBitboard = nextBlack ? board.blackBitboard : board.whiteBitboard; // The bitboard_all of the pieces that can move next
+    bitboard_all enemyBitboard = nextBlack ? board.whiteBitboard : board.blackBitboard; // The bitboard_all of the pieces that can be captured
+
+    bitboard controlPieces = controlBitboard&0xffffffff;
+    bitboard controlKings = controlBitboard>>32;
+    bitboard enemyPieces = enemyBitboard&0xffffffff;
     bitboard controlPawns = controlPieces^controlKings;
-    for(int i = 0; i < BOARD_SIZE; i++){
-        if((controlPawns)&(1<<i))
-        {
-            searchMoves(i, 0, i, enemyPieces, false, controlPieces);
-        }
+    bitboard empty = ~(controlPieces | enemyPieces);
+
+    bitboard jumpers = nextBlack ? getJumpers<true>(controlKings, controlKings, enemyPieces, empty) : getJumpers<false>(controlKings, controlKings, enemyPieces, empty);
+    while(jumpers){
+        unsigned int index = __builtin_ctz(jumpers);
+        searchMoves(index ^ SIDE_SQUARE_MIRROR[nextBlack], 0, index, enemyPieces, true, controlPieces);
+        jumpers &= jumpers - 1;
     }
     if(!availableMoves.empty())
         return;
 
-    bitboard anyPieces = controlPieces | enemyPieces;
-    for(int i = 0; i < BOARD_SIZE; i++){
-        if((controlPieces&(1<<i))==0)
-            continue;
-        // Move top-left
-        if(i>3 && i%8!=4 && (anyPieces&(1<<tl(i))) == 0)
-        {
-            availableMoves.push_back(i | (Direction::topLeft<<5));
-        }
-        // Move top-right
-        if(i>3 && i%8!=3 && (anyPieces&(1<<tr(i))) == 0)
-        {
-            availableMoves.push_back(i | (Direction::topRight<<5));
-        }
-
-        if(controlKings&(1<<i))
-        {
-            // Move bottom-left
-            if(i<28 && i%8!=4 && (anyPieces&(1<<bl(i))) == 0)
-            {
-                availableMoves.push_back(i | (Direction::bottomLeft<<5));
-            }
-            // Move bottom-right
-            if(i<28 && i%8!=3 && (anyPieces&(1<<br(i))) == 0)
-            {
-                availableMoves.push_back(i | (Direction::bottomRight<<5));
-            }
-        }
+    bitboard promotionRowPawns = controlPawns & PROMOTION_ROW[nextBlack]; // Pawns standing on the promotion row jump as kings
+    jumpers = nextBlack ? getJumpers<true>(controlPawns, promotionRowPawns, enemyPieces, empty) : getJumpers<false>(controlPawns, promotionRowPawns, enemyPieces, empty);
+    while(jumpers){
+        unsigned int index = __builtin_ctz(jumpers);
+        searchMoves(index ^ SIDE_SQUARE_MIRROR[nextBlack], 0, index, enemyPieces, false, controlPieces);
+        jumpers &= jumpers - 1;
     }
 }
 
 Game::Game(){
-    addGameState(GameState(Board(0xfff00000, 0xfff), true));
+    history.reserve(RESERVED_HISTORY);
+    reset(GameState(Board(0xfff00000, 0xfff), true));
 }
 
 Game::Game(const GameState& state) {
-    addGameState(state);
+    history.reserve(RESERVED_HISTORY);
+    reset(state);
 }
 
 void Game::addGameState(const GameState& state) {
-    gameHistory.push_back(state);
+    history.push_back({whiteBitboard, blackBitboard, 0, hash, nextBlack});
+    setPosition(state.board.whiteBitboard, state.board.blackBitboard, state.nextBlack, state.getHash());
 }
 
 void Game::undoMove() {
-    if (gameHistory.size() <= 1) {
+    if (history.empty()) {
         throw std::runtime_error("Cannot undo move. No moves have been made.");
     }
-    gameHistory.pop_back();
+    const MoveRecord &record = history.back();
+    setPosition(record.whiteBitboard, record.blackBitboard, record.nextBlack, record.hash);
+    history.pop_back();
 }
 
 void Game::reset(const GameState& state) {
-    gameHistory.clear();
-    addGameState(state);
+    history.clear();
+    setPosition(state.board.whiteBitboard, state.board.blackBitboard, state.nextBlack, state.getHash());
 }
 
 const GameState& Game::getGameState() const {
-    return gameHistory.back();
+    if (!currentState)
+        currentState.emplace(getBoard(), nextBlack);
+    return *currentState;
+}
+
+Board Game::getBoard() const {
+    return {whiteBitboard, blackBitboard};
+}
+
+bool Game::isNextBlack() const {
+    return nextBlack;
+}
+
+zobrist_key Game::getHash() const {
+    return hash;
+}
+
+/**
+ * @brief Checks whether the current position (including the side to move) occurred earlier in the game
+ *
+ * Pawn moves and captures are irreversible, so the history is only scanned back to the last position with different pawns or a different number of pieces.
+ */
+bool Game::isRepetition() const {
+    auto pawns = [](bitboard_all pieces) { return static_cast<bitboard>(pieces & ~(pieces >> 32)); };
+    const int pieceCount = __builtin_popcount(static_cast<bitboard>(whiteBitboard | blackBitboard));
+    for (auto record = history.rbegin(); record != history.rend(); ++record) {
+        if (pawns(record->whiteBitboard) != pawns(whiteBitboard) || pawns(record->blackBitboard) != pawns(blackBitboard) ||
+            __builtin_popcount(static_cast<bitboard>(record->whiteBitboard | record->blackBitboard)) != pieceCount)
+            return false;
+        if (record->hash == hash)
+            return true;
+    }
+    return false;
+}
+
+void Game::setPosition(bitboard_all white, bitboard_all black, bool blackNext, zobrist_key positionHash) {
+    whiteBitboard = white;
+    blackBitboard = black;
+    nextBlack = blackNext;
+    hash = positionHash;
+    currentState.reset();
 }
 
 std::ostream& operator<<(std::ostream& os, const GameState& gameState) {
@@ -467,49 +592,66 @@ std::ostream& operator<<(std::ostream& os, const GameState& gameState) {
     return os;
 }
 
+/**
+ * @brief Makes a move received from outside of the search (agents, players, the console interface)
+ *
+ * The move is validated against the available moves first. A sub-move that is not final only has to be the beginning of an available move.
+ * @param pieceMove The move to make
+ * @param final Whether the sub-move is the last one of the whole move (with multiple jumps there is only one final sub-move)
+ */
 void Game::makeMove(piece_move pieceMove, bool final) {
-    // Final indicates whether the sub-move is the last one of the whole move (with multiple jumps there is only one final sub-move)
 #if CHECK_VALID_MOVES
-    if (std::find(gameHistory.back().getAvailableMoves().begin(), gameHistory.back().getAvailableMoves().end(), pieceMove) == gameHistory.back().getAvailableMoves().end()) {
+    const MoveList &availableMoves = getGameState().getAvailableMoves();
+    unsigned int moveBits = 5;
+    while (moveBits < 64 && pieceMove >> moveBits)
+        moveBits += 3;
+    piece_move prefixMask = final || moveBits >= 64 ? ~piece_move(0) : (piece_move(1) << moveBits) - 1;
+    if (std::none_of(availableMoves.begin(), availableMoves.end(), [&](piece_move move){ return (move & prefixMask) == pieceMove; })) {
         std::ostringstream oss;
-        Move move = gameHistory.back().getMove(pieceMove);
-        oss<<"Invalid move: "<<move<<"(id: "<<pieceMove<<") is not in available moves. For board state:\n"<<gameHistory.back();
+        Move move = getGameState().getMove(pieceMove);
+        oss<<"Invalid move: "<<move<<"(id: "<<pieceMove<<") is not in available moves. For board state:\n"<<getGameState();
 
         throw std::runtime_error(oss.str());
     }
 #endif
+    makeMoveUnchecked(pieceMove, final);
+}
 
-    unsigned int currentPos = pieceMove & 0x1f;
+/**
+ * @brief Makes a move without validating it
+ *
+ * Used by the search, which only plays moves it has just generated.
+ * @param pieceMove The move to make (has to be one of the available moves, or the beginning of one if it is not final)
+ * @param final Whether the sub-move is the last one of the whole move
+ */
+void Game::makeMoveUnchecked(piece_move pieceMove, bool final) {
+    history.push_back({whiteBitboard, blackBitboard, pieceMove, hash, nextBlack});
+    unsigned int currentPos = (pieceMove & 0x1f) ^ SIDE_SQUARE_MIRROR[nextBlack];
 
     pieceMove >>= 5;
-    Board perspectiveBoard = gameHistory.back().getPerspectiveBoard();
-    bitboard_all controlBitboard = perspectiveBoard.whiteBitboard;
-    bitboard_all enemyBitboard = perspectiveBoard.blackBitboard;
+    bitboard_all controlBitboard = nextBlack ? blackBitboard : whiteBitboard;
+    bitboard_all enemyBitboard = nextBlack ? whiteBitboard : blackBitboard;
     bool isKing = controlBitboard & (1ll << (currentPos + 32));
 
     while (pieceMove) {
-        unsigned int direction = static_cast<Direction>(pieceMove & 0x7);
-        controlBitboard &= (~(1ll << currentPos)) & (~(1ll << (currentPos + 32)));
-        for(int i = 0; i<2; i++){
-            if (direction == Direction::topLeft)
-                currentPos = tl(currentPos);
-            else if (direction == Direction::topRight)
-                currentPos = tr(currentPos);
-            else if (direction == Direction::bottomLeft)
-                currentPos = bl(currentPos);
-            else if (direction == Direction::bottomRight)
-                currentPos = br(currentPos);
-            else
-                throw std::runtime_error("Invalid direction.");
-
-            if(enemyBitboard & (1ll<<currentPos))
-                enemyBitboard &= (~((1ll<<currentPos) | (1ll<<(currentPos+32))));
-            else
-                break;
+        unsigned int direction = (pieceMove & 0x7) - 1;
+        if (direction >= NUM_DIRECTIONS) {
+            undoMove();
+            throw std::runtime_error("Invalid direction.");
+        }
+        direction ^= SIDE_DIRECTION_MIRROR[nextBlack];
+        controlBitboard &= ~((bitboard_all(1) << currentPos) | (bitboard_all(1) << (currentPos + 32)));
+
+        unsigned int neighbor = BOARD_TABLES.neighbor[currentPos][direction];
+        bitboard_all neighborBits = BOARD_TABLES.squareBit[neighbor] | (bitboard_all(BOARD_TABLES.squareBit[neighbor]) << 32);
+        if (enemyBitboard & BOARD_TABLES.squareBit[neighbor]) { // Jump over the enemy piece
+            enemyBitboard &= ~neighborBits;
+            currentPos = BOARD_TABLES.landing[currentPos][direction];
         }
+        else
+            currentPos = neighbor;
 
-        if (king_row(currentPos))
-            isKing = true;
+        isKing |= (PROMOTION_ROW[nextBlack] & BOARD_TABLES.squareBit[currentPos]) != 0;
 
         pieceMove >>= 3;
 
@@ -518,13 +660,18 @@ void Game::makeMove(piece_move pieceMove, bool final) {
             controlBitboard |= (1ll << (currentPos + 32));
     }
 
-    Board newBoard(controlBitboard, enemyBitboard);
+    const bitboard_all previousControl = nextBlack ? blackBitboard : whiteBitboard;
+    const bitboard_all previousEnemy = nextBlack ? whiteBitboard : blackBitboard;
+    zobrist_key newHash = hash ^ zobristDelta(previousControl, controlBitboard, nextBlack) ^ zobristDelta(previousEnemy, enemyBitboard, !nextBlack);
+    if (final)
+        newHash ^= ZOBRIST_KEYS.blackToMove;
 
-    const GameState newGameState(gameHistory.back().nextBlack ? newBoard.getBoardRev() : newBoard,
-                                 gameHistory.back().nextBlack^final);
-    addGameState(newGameState);
+    if (nextBlack)
+        setPosition(enemyBitboard, controlBitboard, !final, newHash);
+    else
+        setPosition(controlBitboard, enemyBitboard, final, newHash);
 }
 
 bool Game::isFinished() const {
-    return gameHistory.back().getAvailableMoves().empty();
+    return !getGameState().hasAnyMove();
 }
@@ -0,0 +1,90 @@
+#ifndef BOARD_KEY_HPP
+#define BOARD_KEY_HPP
+
+#include <cstdint>
+
+#include "game.hpp"
+
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Packs the bits of value selected by mask into the lowest bits (pext)
+ * @tparam portable Whether to use the portable loop even if BMI2 is available (to verify one path against the other)
+ */
+template<bool portable = false>
+inline uint32_t extractBits(bitboard value, bitboard mask){
+#ifdef __BMI2__
+    if constexpr (!portable)
+        return _pext_u32(value, mask);
+#endif
+    uint32_t result = 0;
+    for(uint32_t bit = 1; mask; bit <<= 1){
+        if(value & mask & -mask)
+            result |= bit;
+        mask &= mask - 1;
+    }
+    return result;
+}
+
+/**
+ * @brief Spreads the lowest bits of value to the positions selected by mask (pdep, inverse of extractBits)
+ * @tparam portable Whether to use the portable loop even if BMI2 is available (to verify one path against the other)
+ */
+template<bool portable = false>
+inline bitboard depositBits(uint32_t value, bitboard mask){
+#ifdef __BMI2__
+    if constexpr (!portable)
+        return _pdep_u32(value, mask);
+#endif
+    bitboard result = 0;
+    for(uint32_t bit = 1; mask; bit <<= 1){
+        if(value & bit)
+            result |= mask & -mask;
+        mask &= mask - 1;
+    }
+    return result;
+}
+
+/**
+ * @struct BoardKey
+ * @brief Compact 96-bit encoding of a board and the side to move
+ *
+ * Only occupied squares carry the color and the king flag, so the 24 pieces at most fit into 24 bits each.
+ * The encoding is exact (toBoard restores the board), so it can verify entries of transposition or opening tables.
+ *
+ * @var occupied The squares occupied by any piece
+ * @var black For each occupied square (in index order) whether the piece is black, the highest bit is set if black plays next
+ * @var kings For each occupied square (in index order) whether the piece is a king
+ */
+struct BoardKey {
+    bitboard occupied = 0;
+    uint32_t black = 0;
+    uint32_t kings = 0;
+
+    static constexpr uint32_t BLACK_TO_MOVE = 1u << 31;
+
+    template<bool portable = false>
+    static BoardKey fromBoard(const Board &board, bool nextBlack){
+        bitboard occupied = board.getWhitePieces() | board.getBlackPieces();
+        return {occupied,
+                extractBits<portable>(board.getBlackPieces(), occupied) | (nextBlack ? BLACK_TO_MOVE : 0),
+                extractBits<portable>(board.getWhiteKings() | board.getBlackKings(), occupied)};
+    }
+
+    template<bool portable = false>
+    Board toBoard() const {
+        bitboard blackPieces = depositBits<portable>(black, occupied);
+        bitboard kingPieces = depositBits<portable>(kings, occupied);
+        bitboard whitePieces = occupied & ~blackPieces;
+        return {whitePieces | (static_cast<bitboard_all>(whitePieces & kingPieces) << 32),
+                blackPieces | (static_cast<bitboard_all>(blackPieces & kingPieces) << 32)};
+    }
+
+    bool isNextBlack() const { return black & BLACK_TO_MOVE; }
+
+    bool operator==(const BoardKey &other) const = default;
+};
+
+#endif // BOARD_KEY_HPP
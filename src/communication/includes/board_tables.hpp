@@ -0,0 +1,113 @@
+#ifndef BOARD_TABLES_HPP
+#define BOARD_TABLES_HPP
+
+#include <array>
+#include <cstdint>
+
+#include "game.hpp"
+
+/*
+ * Compile-time tables describing the geometry of the board (in absolute coordinates, white at the bottom).
+ * Squares are indexed as in bitboards, directions as Direction - 1 (topLeft, topRight, bottomLeft, bottomRight).
+ * NO_SQUARE is used for targets outside the board, its bit in squareBit is empty,
+ * so lookups never need to test the board edges.
+ *
+ * Moves (piece_move) are encoded from the perspective of the player to move, i.e. rotated by 180 degrees for black.
+ * Instead of reversing the bitboards, black's moves are generated on the absolute board with mirrored squares and directions:
+ * the perspective square is square ^ SIDE_SQUARE_MIRROR[black], the perspective direction index is direction ^ SIDE_DIRECTION_MIRROR[black]
+ * (top-left <-> bottom-right, top-right <-> bottom-left).
+ */
+
+constexpr unsigned int NO_SQUARE = NUM_SQUARES; ///< Target outside the board
+constexpr unsigned int NUM_DIRECTIONS = 4;
+
+constexpr bitboard EVEN_ROWS = 0x0f0f0f0f; ///< Rows 0, 2, 4, 6 (shifted one tile to the right)
+constexpr bitboard ODD_ROWS = 0xf0f0f0f0; ///< Rows 1, 3, 5, 7
+constexpr bitboard PROMOTION_ROW[2] = {0x0000000f, 0xf0000000}; ///< The row where pawns get promoted (white, black)
+constexpr unsigned int SIDE_SQUARE_MIRROR[2] = {0, NUM_SQUARES - 1}; ///< Xor mask converting between absolute and perspective squares (white, black)
+constexpr unsigned int SIDE_DIRECTION_MIRROR[2] = {0, 3}; ///< Xor mask converting between absolute and perspective direction indices (white, black)
+
+/**
+ * @struct BoardTables
+ * @brief Neighbor, jump and validity tables for all squares.
+ *
+ * @var squareBit The bitboard of each square (empty for NO_SQUARE)
+ * @var neighbor The adjacent square in each direction (also the square jumped over)
+ * @var landing The square where a jump in each direction lands
+ * @var stepMask The squares from which a step in each direction stays on the board
+ * @var jumpMask The squares from which a jump in each direction stays on the board
+ */
+struct BoardTables {
+    std::array<bitboard, NUM_SQUARES + 1> squareBit{};
+    std::array<std::array<uint8_t, NUM_DIRECTIONS>, NUM_SQUARES + 1> neighbor{};
+    std::array<std::array<uint8_t, NUM_DIRECTIONS>, NUM_SQUARES + 1> landing{};
+    std::array<bitboard, NUM_DIRECTIONS> stepMask{};
+    std::array<bitboard, NUM_DIRECTIONS> jumpMask{};
+};
+
+constexpr BoardTables generateBoardTables(){
+    constexpr int dx[NUM_DIRECTIONS] = {-1, 1, -1, 1};
+    constexpr int dy[NUM_DIRECTIONS] = {-1, -1, 1, 1};
+    auto squareAt = [](int x, int y) -> unsigned int {
+        if(x < 0 || x > 7 || y < 0 || y > 7)
+            return NO_SQUARE;
+        return x / 2 + y * 4;
+    };
+
+    BoardTables tables;
+    for(unsigned int square = 0; square <= NUM_SQUARES; square++){
+        tables.squareBit[square] = square < NUM_SQUARES ? bitboard(1) << square : 0;
+        for(unsigned int direction = 0; direction < NUM_DIRECTIONS; direction++){
+            tables.neighbor[square][direction] = NO_SQUARE;
+            tables.landing[square][direction] = NO_SQUARE;
+        }
+    }
+    for(unsigned int square = 0; square < NUM_SQUARES; square++){
+        int y = square / 4;
+        int x = (square % 4) * 2 + (y % 2 == 0);
+        for(unsigned int direction = 0; direction < NUM_DIRECTIONS; direction++){
+            unsigned int neighbor = squareAt(x + dx[direction], y + dy[direction]);
+            unsigned int landing = squareAt(x + 2 * dx[direction], y + 2 * dy[direction]);
+            tables.neighbor[square][direction] = neighbor;
+            tables.landing[square][direction] = neighbor == NO_SQUARE ? NO_SQUARE : landing;
+            if(neighbor != NO_SQUARE)
+                tables.stepMask[direction] |= bitboard(1) << square;
+            if(landing != NO_SQUARE)
+                tables.jumpMask[direction] |= bitboard(1) << square;
+        }
+    }
+    return tables;
+}
+
+inline constexpr BoardTables BOARD_TABLES = generateBoardTables();
+
+/**
+ * @brief Returns the squares whose neighbor in the given direction belongs to the given squares
+ *
+ * Works on whole bitboards: the neighbor of a square is 3, 4 or 5 bits away depending on the direction and the parity of its row.
+ */
+template<Direction direction>
+constexpr bitboard withNeighborIn(bitboard squares){
+    constexpr unsigned int index = direction - 1;
+    constexpr unsigned int evenShift[NUM_DIRECTIONS] = {4, 3, 4, 5};
+    constexpr unsigned int oddShift[NUM_DIRECTIONS] = {5, 4, 3, 4};
+    if constexpr (direction == Direction::topLeft || direction == Direction::topRight)
+        return (((squares << evenShift[index]) & EVEN_ROWS) | ((squares << oddShift[index]) & ODD_ROWS)) & BOARD_TABLES.stepMask[index];
+    else
+        return (((squares >> evenShift[index]) & EVEN_ROWS) | ((squares >> oddShift[index]) & ODD_ROWS)) & BOARD_TABLES.stepMask[index];
+}
+
+/**
+ * @brief Returns the squares whose jump in the given direction lands on one of the given squares
+ */
+template<Direction direction>
+constexpr bitboard withLandingIn(bitboard squares){
+    constexpr unsigned int index = direction - 1;
+    constexpr unsigned int shift[NUM_DIRECTIONS] = {9, 7, 7, 9};
+    if constexpr (direction == Direction::topLeft || direction == Direction::topRight)
+        return (squares << shift[index]) & BOARD_TABLES.jumpMask[index];
+    else
+        return (squares >> shift[index]) & BOARD_TABLES.jumpMask[index];
+}
+
+#endif // BOARD_TABLES_HPP
@@ -1,12 +1,14 @@
 #ifndef GAME_HPP
 #define GAME_HPP
 
+#include <array>
 #include <optional>
 #include <vector>
 #include <span>
 #include <cstdint>
 #include <functional>
 #include <iostream>
+#include <stdexcept>
 
 #define CHECK_VALID_MOVES true
 
@@ -46,6 +48,47 @@ using bitboard = uint32_t;
  */
 using piece_move = uint64_t;
 
+constexpr unsigned int MAX_MOVES = 128; ///< Capacity of a move list (12 pieces with at most 4 quiet moves each give 48, the rest is headroom for branching capture sequences)
+
+/**
+ * @class MoveList
+ * @brief Fixed-capacity list of moves stored inline
+ *
+ * Replaces std::vector<piece_move> in move generation and search so that no heap allocations are made per node.
+ * Only the used part of the storage is copied.
+ *
+ * @var moves The storage of the moves (only the first count entries are valid)
+ * @var count The number of moves in the list
+ */
+class MoveList {
+public:
+    MoveList() = default;
+    MoveList(const MoveList& other);
+    MoveList& operator=(const MoveList& other);
+
+    inline void push_back(piece_move move){
+        if(count >= MAX_MOVES)
+            throw std::length_error("Move list capacity exceeded.");
+        moves[count++] = move;
+    }
+    inline void clear() { count = 0; }
+    inline unsigned int size() const { return count; }
+    inline bool empty() const { return count == 0; }
+
+    inline piece_move* data() { return moves.data(); }
+    inline const piece_move* data() const { return moves.data(); }
+    inline piece_move* begin() { return moves.data(); }
+    inline piece_move* end() { return moves.data() + count; }
+    inline const piece_move* begin() const { return moves.data(); }
+    inline const piece_move* end() const { return moves.data() + count; }
+    inline piece_move& operator[](unsigned int index) { return moves[index]; }
+    inline const piece_move& operator[](unsigned int index) const { return moves[index]; }
+
+private:
+    std::array<piece_move, MAX_MOVES> moves;
+    unsigned int count = 0;
+};
+
 /**
  * @class Move
  * @brief Represents a move on the board
@@ -63,6 +106,7 @@ struct Move {
 
 using position = uint8_t;
 using board_id = __int128;
+using zobrist_key = uint64_t;
 
 /**
  * @class Board
@@ -104,6 +148,9 @@ Board getBoardFromStream(std::istream& inputStream);
 /**
  * @class GameState
  * @brief Represents the state of the game
+ *
+ * The available moves are generated lazily on the first request (leaf nodes of the search usually do not need them).
+ *
  * @var board The board of the game
  * @var nextBlack Whether the black plays next
  */
@@ -114,22 +161,59 @@ public:
 
     GameState(Board board, bool nextBlack);
     Board getPerspectiveBoard() const; ///< Returns the board from the perspective of the next player
-    std::span<const piece_move> getAvailableMoves() const; ///< Returns the available moves for the current player
+    const MoveList& getAvailableMoves() const; ///< Returns the available moves for the current player
+    bool hasAnyMove() const; ///< Returns whether the current player can move (without generating the moves)
+    bool hasCapture() const; ///< Returns whether the current player can capture (without generating the moves)
+    const MoveList& getCaptureMoves() const; ///< Returns the capture moves for the current player (empty if there are none)
     Move getMove(piece_move pieceMove) const; ///< Converts piece_move to Move class
+    zobrist_key getHash() const; ///< Computes the Zobrist hash of the state from scratch (equal to Game::getHash for the same position)
     std::vector<Move> getAvailableMoves2() const; ///< Returns the available moves for the current player as a vector of Move
 
     friend std::ostream& operator<<(std::ostream& os, const GameState& obj); ///< Outputs the game state to the stream
 
 private:
-    void calculateAvailableMoves(); ///< Finds the available moves for the current player
-    void searchMoves(piece_move currentMove, unsigned int jumpCount, position lastPos, bitboard curEnemyPieces, bool isKing, bitboard controlPieces); ///< Recursive function to find the available moves
-    std::vector<piece_move> availableMoves; ///< The available moves for the current player
+    void calculateAvailableMoves() const; ///< Finds the available moves for the current player
+    void calculateCaptureMoves() const; ///< Finds the capture moves for the current player
+    void searchMoves(piece_move currentMove, unsigned int jumpCount, position lastPos, bitboard curEnemyPieces, bool isKing, bitboard controlPieces) const; ///< Recursive function to find the available moves
+    mutable MoveList availableMoves; ///< The available moves for the current player (valid once movesCalculated is set)
+    mutable bool movesCalculated = false; ///< Whether the available moves were already generated
+};
+
+constexpr size_t RESERVED_HISTORY = 256; ///< Number of records reserved in the game history (exceeds any search depth)
+
+/**
+ * @struct MoveRecord
+ * @brief Entry of the game history: the state before a move (restored by undoing the move) and the move itself
+ *
+ * @var whiteBitboard The bitboard of the white pieces before the move
+ * @var blackBitboard The bitboard of the black pieces before the move
+ * @var move The move made from the state (0 for states added directly)
+ * @var hash The Zobrist hash before the move
+ * @var nextBlack Whether black played next before the move
+ */
+struct MoveRecord {
+    bitboard_all whiteBitboard;
+    bitboard_all blackBitboard;
+    piece_move move;
+    zobrist_key hash;
+    bool nextBlack;
 };
 
 /**
  * @class Game
  * @brief Controls the game mechanics
- * @var gameHistory The states of the game
+ *
+ * The current position is kept as plain bitboards and every move pushes a small record, so making and undoing moves
+ * in the search neither constructs game states nor allocates (the capacity of the history is reserved up front).
+ * The GameState returned by getGameState is a view of the current position built on request and invalidated by any change.
+ * The Zobrist hash of the position is updated incrementally by every move.
+ *
+ * @var whiteBitboard The bitboard of the white pieces of the current position
+ * @var blackBitboard The bitboard of the black pieces of the current position
+ * @var nextBlack Whether black plays next in the current position
+ * @var hash The Zobrist hash of the current position
+ * @var history The records of the previous positions
+ * @var currentState The view of the current position (empty until requested)
  */
 class Game {
 public:
@@ -138,12 +222,24 @@ public:
     void addGameState(const GameState& state); ///< Adds a new state to the game
     void undoMove(); ///< Undoes the last move
     void reset(const GameState& state); ///< Resets the game to the given state
-    const GameState& getGameState() const; ///< Returns the current state of the game
-    void makeMove(piece_move pieceMove, bool final=true); ///< Makes a move
+    const GameState& getGameState() const; ///< Returns the current state of the game (valid until the next change of the game, not thread-safe: builds the cached state)
+    Board getBoard() const; ///< Returns the current board (without building the game state)
+    bool isNextBlack() const; ///< Returns whether black plays next
+    zobrist_key getHash() const; ///< Returns the Zobrist hash of the current position
+    bool isRepetition() const; ///< Returns whether the current position occurred earlier in the game
+    void makeMove(piece_move pieceMove, bool final=true); ///< Makes a move after validating it (for moves coming from agents, players or the console)
+    void makeMoveUnchecked(piece_move pieceMove, bool final=true); ///< Makes a trusted move without validation (for moves generated by the search)
     bool isFinished() const; ///< Returns whether the game has finished (no available moves)
 
 private:
-    std::vector<GameState> gameHistory;
+    void setPosition(bitboard_all white, bitboard_all black, bool blackNext, zobrist_key positionHash); ///< Replaces the current position and invalidates its view
+
+    bitboard_all whiteBitboard = 0;
+    bitboard_all blackBitboard = 0;
+    bool nextBlack = true;
+    zobrist_key hash = 0;
+    std::vector<MoveRecord> history;
+    mutable std::optional<GameState> currentState;
 };
 
 #endif // GAME_HPP
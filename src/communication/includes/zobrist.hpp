@@ -0,0 +1,68 @@
+#ifndef ZOBRIST_HPP
+#define ZOBRIST_HPP
+
+#include <array>
+#include <cstdint>
+
+#include "game.hpp"
+
+/*
+ * Zobrist hashing: every (piece, square) pair and the side to move have a random 64-bit key,
+ * the hash of a position is the xor of the keys of its pieces (and of ZobristKeys::blackToMove if black plays next).
+ * A move therefore updates the hash by xor-ing only the keys of the squares it changed.
+ */
+
+/**
+ * @struct ZobristKeys
+ * @brief The random keys of all pieces on all squares (indexed by Piece) and of the side to move.
+ */
+struct ZobristKeys {
+    std::array<std::array<zobrist_key, NUM_SQUARES>, 4> pieceSquare{};
+    zobrist_key blackToMove = 0;
+};
+
+constexpr ZobristKeys generateZobristKeys(){
+    uint64_t state = 0x9e3779b97f4a7c15; // Fixed seed, hashes are stable between runs (usable in opening books)
+    auto next = [&state]() -> zobrist_key { // splitmix64
+        state += 0x9e3779b97f4a7c15;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+    };
+
+    ZobristKeys keys;
+    for(auto &piece : keys.pieceSquare)
+        for(zobrist_key &key : piece)
+            key = next();
+    keys.blackToMove = next();
+    return keys;
+}
+
+inline constexpr ZobristKeys ZOBRIST_KEYS = generateZobristKeys();
+
+/**
+ * @brief Returns the xor of the keys of the given piece on the given squares
+ */
+inline zobrist_key zobristSquares(bitboard squares, Piece piece){
+    zobrist_key key = 0;
+    while(squares){
+        key ^= ZOBRIST_KEYS.pieceSquare[piece][__builtin_ctz(squares)];
+        squares &= squares - 1;
+    }
+    return key;
+}
+
+/**
+ * @brief Returns the change of the hash between two bitboards of one player (pieces in the low 32 bits, kings in the high 32 bits)
+ *
+ * Only the squares whose content differs are visited. With before = 0 it returns the hash of the pieces of the player.
+ */
+inline zobrist_key zobristDelta(bitboard_all before, bitboard_all after, bool black){
+    auto pawns = [](bitboard_all pieces) { return static_cast<bitboard>(pieces & ~(pieces >> 32)); };
+    auto kings = [](bitboard_all pieces) { return static_cast<bitboard>(pieces >> 32); };
+    return zobristSquares(pawns(before) ^ pawns(after), black ? Piece::blackPawn : Piece::whitePawn) ^
+           zobristSquares(kings(before) ^ kings(after), black ? Piece::blackKing : Piece::whiteKing);
+}
+
+#endif // ZOBRIST_HPP
@@ -40,7 +40,45 @@ const std::string CURRENT_AGENT_CONFIG = R"(
     "move_time_limit": 500,
     "use_alpha_beta": true,
     "use_cache": true,
-    "reorder_moves": false
+    "use_bound_cutoffs": false,
+    "reorder_moves": false,
+    "use_quiescence": true,
+    "use_pvs": false,
+    "use_killer_moves": false,
+    "use_history_heuristic": true,
+    "use_late_move_reductions": true,
+    "late_move_reductions":
+    [
+        [0, 0, 0, 0, 0, 0, 0, 0],
+        [0, 0, 0, 0, 0, 0, 0, 0],
+        [0, 0, 0, 0, 0, 0, 0, 0],
+        [0, 0, 0, 1, 1, 1, 1, 1],
+        [0, 0, 0, 1, 1, 1, 2, 2],
+        [0, 0, 0, 1, 1, 2, 2, 2],
+        [0, 0, 0, 1, 2, 2, 2, 3],
+        [0, 0, 0, 1, 2, 2, 3, 3]
+    ],
+    "use_probcut": false,
+    "probcut_margin": 300,
+    "probcut_reduction": 4,
+    "probcut_min_depth": 6,
+    "use_razoring": false,
+    "razoring_margins": [0, 0, 600, 1200],
+    "use_futility_pruning": false,
+    "futility_margins": [0, 250, 500],
+    "aspiration_window": 0,
+    "aspiration_widening": 4,
+    "random_seed": 0,
+    "threads": 1,
+    "min_split_depth": 4,
+    "time_check_interval": 1024,
+    "time_moves_to_go": 30,
+    "time_max_factor": 4,
+    "time_stable_iterations": 4,
+    "time_score_drop": 100,
+    "log_time_usage": false,
+    "ponder": false,
+    "log_pondering": false
 }
 )"; ///< The default configuration for the agent, used for building the executable agent
 #endif
\ No newline at end of file
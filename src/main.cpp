@@ -11,9 +11,11 @@
 #include "app/includes/app.hpp"
 #include "ai/includes/console_interface.hpp"
 #include "meta/includes/tournament.hpp"
+#include "tests/includes/performance_tests.hpp"
 
 //#define CLI
 #define TOURNAMENT
+//#define BENCHMARK
 
 int main()
 {
@@ -43,4 +45,14 @@ int main()
     Tournament tournament = Tournament::createFromFile(tournamentConfigFile);
 
 #endif
+#ifdef BENCHMARK
+    // Compare the search configurations on a fixed position suite
+
+    killerMovesTest();
+    searchPerformanceTest();
+    forwardPruningPerformanceTest();
+    mtdfPerformanceTest();
+    timeCheckPerformanceTest();
+    parallelSearchPerformanceTest();
+#endif
 }
@@ -0,0 +1,126 @@
+#include <fstream>
+#include <iostream>
+#include <format>
+#include <string>
+#include <thread>
+
+#include "communication/includes/debugging.hpp"
+#include "communication/includes/game.hpp"
+#include "tests/includes/perft.hpp"
+
+const std::string PERFT_USAGE = R"(Usage: checkers_perft [options]
+  --depth N        Maximal depth of the tree (default: 10)
+  --divide         List the leaf count of each root move at the maximal depth
+  --threads N      Number of threads splitting the tree (default: number of hardware threads)
+  --hash MB        Size of the table reusing counts of transposed subtrees (default: 0 = disabled)
+  --validate       Play moves through the validated path used for external moves (measures the validation overhead)
+                   and check that the compact board keys restore the positions of random playouts
+  --position FILE  Start from the position in FILE instead of the starting position ("-" reads from standard input)
+                   The file contains the side to move (black or white) followed by the board in the protocol format
+)";
+
+/**
+ * Counts the leaf nodes of the game tree (perft) for all depths up to the maximal one and reports the speed of the move generator.
+ * The counts of the starting position are compared with the reference counts.
+ */
+int main(int argc, char *argv[])
+{
+    int maxDepth = 10;
+    bool showDivide = false;
+    PerftOptions options;
+    options.threads = std::max(std::thread::hardware_concurrency(), 1u);
+    size_t hashMegabytes = 0;
+    std::optional<GameState> startState;
+
+    for(int i = 1; i < argc; i++){
+        std::string argument = argv[i];
+        if(argument == "--depth" && i + 1 < argc){
+            maxDepth = std::stoi(argv[++i]);
+        }
+        else if(argument == "--threads" && i + 1 < argc){
+            options.threads = std::max(std::stoi(argv[++i]), 1);
+        }
+        else if(argument == "--hash" && i + 1 < argc){
+            hashMegabytes = std::stoull(argv[++i]);
+        }
+        else if(argument == "--validate"){
+            options.validateMoves = true;
+        }
+        else if(argument == "--divide"){
+            showDivide = true;
+        }
+        else if(argument == "--position" && i + 1 < argc){
+            std::string path = argv[++i];
+            if(path == "-"){
+                startState.emplace(getGameStateFromStream(std::cin));
+            }
+            else{
+                std::ifstream input(path);
+                if(!input.is_open())
+                    message(std::format("Position file {} not found.", path), false, true, true);
+                startState.emplace(getGameStateFromStream(input));
+            }
+        }
+        else{
+            std::cout<<PERFT_USAGE;
+            return 1;
+        }
+    }
+
+    GameState initialState(Board(0xfff00000, 0xfff), true);
+    Game game(startState.value_or(initialState));
+    bool useReference = !startState || (startState->board == initialState.board && startState->nextBlack == initialState.nextBlack);
+
+    std::optional<PerftTable> table;
+    if(hashMegabytes > 0)
+        table.emplace(hashMegabytes);
+    options.table = table ? &*table : nullptr;
+
+    message(std::format("Running perft ({} threads, {}, {} moves)", options.threads, table ? std::format("hash table with {} entries", table->size()) : "no hash table",
+                        options.validateMoves ? "validated" : "trusted"), true);
+    std::cout<<game.getGameState()<<std::flush;
+
+    bool mismatch = false;
+    for(int depth = 1; depth <= maxDepth; depth++){
+        PerftResult result = timedPerft(game, depth, options);
+        std::string line = std::format("depth {}: {} nodes [took {}ms, {:.0f} nodes/s]", depth, result.nodes, result.milliseconds, result.nodesPerSecond());
+        if(useReference && static_cast<size_t>(depth) < PERFT_REFERENCE_COUNTS.size()){
+            bool matches = result.nodes == PERFT_REFERENCE_COUNTS[depth];
+            line += matches ? " OK" : std::format(" MISMATCH (expected {})", PERFT_REFERENCE_COUNTS[depth]);
+            mismatch |= !matches;
+        }
+        message(line);
+    }
+
+    if(showDivide && maxDepth > 0){
+        message(std::format("Divide at depth {}", maxDepth), true);
+        uint64_t total = 0;
+        for(const auto &[move, nodes] : divide(game, maxDepth, options)){
+            Move path = game.getGameState().getMove(move);
+            std::string pathString;
+            for(Pos pos: path.path)
+                pathString += std::format("{}({}, {})", pathString.empty() ? "" : " -> ", pos.x, pos.y);
+            message(std::format("{}: {}", pathString, nodes));
+            total += nodes;
+        }
+        message(std::format("total: {}", total));
+    }
+
+    if(options.validateMoves){
+        constexpr unsigned int BOARD_KEY_PLAYOUTS = 10000;
+        BoardKeyCheck check = checkBoardKeys(BOARD_KEY_PLAYOUTS);
+#ifdef __BMI2__
+        const std::string paths = "pext/pdep and portable";
+#else
+        const std::string paths = "portable";
+#endif
+        message(std::format("board keys ({}): {} positions of {} random playouts, {}", paths, check.positions, BOARD_KEY_PLAYOUTS,
+                            check.mismatches == 0 ? "OK" : std::format("{} MISMATCHES", check.mismatches)));
+        mismatch |= check.mismatches > 0;
+    }
+
+    if(table)
+        message(std::format("hash table: {} probes, {} hits ({:.1f}%)", table->getProbes(), table->getHits(), table->hitRate() * 100.0));
+
+    return mismatch ? 1 : 0;
+}
@@ -0,0 +1,20 @@
+#ifndef PERFORMANCE_TESTS_HPP
+#define PERFORMANCE_TESTS_HPP
+
+#include <cstdint>
+
+#include "../../communication/includes/game.hpp"
+
+uint64_t getTreeSize(Game &game, int depth); ///< Counts the nodes of the game tree of the given depth (making every move)
+void interfacePerformanceTest(); ///< Measures the speed of the game interface (move generation, making and undoing moves)
+bool killerMovesTest(); ///< Checks that a beta cutoff is stored as a killer move of the ply of the node which cut off
+void searchPerformanceTest(int maxDepth = 10); ///< Compares the node counts of the search configurations per depth on a fixed position suite
+void forwardPruningPerformanceTest(int maxDepth = 12); ///< Compares the node counts of the forward pruning configurations at a fixed depth on a fixed position suite
+void mtdfPerformanceTest(int maxDepth = 12); ///< Compares the node counts of MTD(f) and IterativeMinimax per depth on a fixed position suite
+void timeCheckPerformanceTest(long long moveTimeLimit = 100); ///< Measures the search speed and the time limit overshoot for several intervals between reads of the clock
+void parallelSearchPerformanceTest(int maxDepth = 12); ///< Compares the time to depth of the parallel searches with 1 to 16 threads on a fixed position suite
+#ifdef MEASURE_ALLOCATIONS
+void allocationPerformanceTest(); ///< Counts the heap allocations made while walking the game tree
+#endif
+
+#endif // PERFORMANCE_TESTS_HPP
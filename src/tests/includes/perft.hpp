@@ -0,0 +1,131 @@
+#ifndef PERFT_HPP
+#define PERFT_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "../../communication/includes/game.hpp"
+
+/**
+ * @brief Known leaf counts of the starting position (index = depth).
+ *
+ * Generated by the move generator for the rules implemented in GameState (jumps are forced and jumps of kings take precedence).
+ * Used to catch move generator regressions.
+ */
+constexpr std::array<uint64_t, 16> PERFT_REFERENCE_COUNTS = {
+        1,
+        7,
+        49,
+        302,
+        1469,
+        7361,
+        36768,
+        179740,
+        845931,
+        3963629,
+        18389276,
+        85134747,
+        387816873,
+        1761836168,
+        7950894648, // Depths 14 and 15 were counted with the perft table
+        36099161245
+};
+
+/**
+ * @struct PerftResult
+ * @brief Result of a perft run.
+ *
+ * @var nodes The number of leaf nodes
+ * @var milliseconds The time the run took
+ */
+struct PerftResult {
+    uint64_t nodes = 0;
+    long long milliseconds = 0;
+    double nodesPerSecond() const; ///< Returns the speed of the run in leaf nodes per second
+};
+
+/**
+ * @struct BoardKeyCheck
+ * @brief Result of the round trip check of the board keys.
+ *
+ * @var positions The number of checked positions
+ * @var mismatches The number of positions whose board key did not restore the board (or differed between the bit operation paths)
+ */
+struct BoardKeyCheck {
+    uint64_t positions = 0;
+    uint64_t mismatches = 0;
+};
+
+/**
+ * @struct PerftTask
+ * @brief Subtree below a root move and a second-ply move, the unit of work of multithreaded perft.
+ *
+ * @var rootIndex The index of the root move (used to accumulate per-root-move counts)
+ * @var rootMove The move played at the root
+ * @var secondMove The reply played after the root move
+ */
+struct PerftTask {
+    unsigned int rootIndex;
+    piece_move rootMove;
+    piece_move secondMove;
+};
+
+/**
+ * @class PerftTable
+ * @brief Hash table storing the leaf counts of already counted subtrees.
+ *
+ * Entries are keyed by the board, the side to move and the remaining depth, so transposed subtrees are counted only once.
+ * The table can be shared by multiple threads: each entry stores its key xor-ed with the count,
+ * so an entry torn by concurrent writes fails the key check instead of returning a wrong count.
+ *
+ * @var entries The entries of the table (the number of entries is a power of 2)
+ * @var probes The number of lookups
+ * @var hits The number of successful lookups
+ */
+class PerftTable {
+private:
+    struct Entry {
+        std::atomic<uint64_t> check{0}; ///< Key xor nodes
+        std::atomic<uint64_t> nodes{0};
+    };
+    std::vector<Entry> entries;
+    std::atomic<uint64_t> probes = 0;
+    std::atomic<uint64_t> hits = 0;
+
+    static uint64_t getKey(zobrist_key hash, int depth); ///< Combines the Zobrist hash of the position with the remaining depth
+public:
+    explicit PerftTable(size_t megabytes);
+    std::optional<uint64_t> probe(const Game &game, int depth); ///< Returns the stored leaf count if the subtree was counted before
+    void store(const Game &game, int depth, uint64_t nodes); ///< Stores the leaf count of a subtree (always replaces)
+    uint64_t getProbes() const; ///< Returns the number of lookups
+    uint64_t getHits() const; ///< Returns the number of successful lookups
+    double hitRate() const; ///< Returns the ratio of successful lookups
+    size_t size() const; ///< Returns the number of entries
+};
+
+/**
+ * @struct PerftOptions
+ * @brief Settings of a perft run.
+ *
+ * @var threads The number of threads splitting the tree
+ * @var table The table of already counted subtrees (nullptr disables it)
+ * @var validateMoves Whether moves are played through the validated Game::makeMove instead of the trusted path used by the search
+ */
+struct PerftOptions {
+    unsigned int threads = 1;
+    PerftTable *table = nullptr;
+    bool validateMoves = false;
+};
+
+uint64_t perft(Game &game, int depth, const PerftOptions &options = {}); ///< Counts the leaf nodes of the game tree of the given depth (leaves are counted in bulk)
+PerftResult timedPerft(Game &game, int depth, const PerftOptions &options = {}); ///< Runs perft and measures its time
+std::vector<std::pair<piece_move, uint64_t>> divide(Game &game, int depth, const PerftOptions &options = {}); ///< Returns the leaf count of the subtree of each root move
+BoardKeyCheck checkBoardKeys(unsigned int playouts, unsigned int seed = 0); ///< Checks that the board keys of the positions of random playouts restore their boards
+GameState getGameStateFromStream(std::istream &inputStream); ///< Reads the side to move ("black" or "white") followed by the board
+
+#endif // PERFT_HPP
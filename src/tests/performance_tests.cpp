@@ -1,16 +1,51 @@
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdlib>
+#include <format>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
 
+#include <nlohmann/json.hpp>
+
+#include "includes/performance_tests.hpp"
 #include "../communication/includes/debugging.hpp"
 #include "../communication/includes/game.hpp"
+#include "../ai/includes/evaluation.hpp"
+#include "../ai/includes/hyperparameters.hpp"
+#include "../ai/includes/search_algorithms.hpp"
+#include "../ai/includes/parallel_search.hpp"
+#include "../includes/constants.hpp"
+
+#ifdef MEASURE_ALLOCATIONS
+// Counts every heap allocation made by the program (used to verify that the search is allocation-free)
+std::atomic<uint64_t> allocationCount = 0;
+
+void* operator new(size_t size){
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if(void *pointer = std::malloc(size))
+        return pointer;
+    throw std::bad_alloc();
+}
 
+void operator delete(void *pointer) noexcept{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept{
+    std::free(pointer);
+}
+#endif
 
 uint64_t getTreeSize(Game &game, int depth){
     if (depth < 1)
         return 1;
-    std::span<const piece_move> possibleMoves = game.getGameState().getAvailableMoves();
+    MoveList possibleMoves = game.getGameState().getAvailableMoves(); // Copy, the game state view is rebuilt after every move
     uint64_t counter = 1;
     for (const piece_move move : possibleMoves) {
-        game.makeMove(move);
+        game.makeMoveUnchecked(move);
         counter += getTreeSize(game, depth - 1);
         game.undoMove();
     }
@@ -28,4 +63,295 @@ void interfacePerformanceTest() {
                 std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()) + "ms]",
                 false);
     }
-}
\ No newline at end of file
+}
+
+#ifdef MEASURE_ALLOCATIONS
+void allocationPerformanceTest() {
+    Game game(GameState(Board(0xfff00000, 0xfff), true));
+    message("Running allocation test", true);
+    for (int d = 1; d < 9; d++) {
+        uint64_t allocationsBefore = allocationCount.load();
+        uint64_t res = getTreeSize(game, d);
+        uint64_t allocations = allocationCount.load() - allocationsBefore;
+        message("depth " + std::to_string(d) + ": " + std::to_string(res) + " nodes, " + std::to_string(allocations) +
+                " heap allocations (" + std::to_string(static_cast<double>(allocations) / static_cast<double>(res)) + " per node)",
+                false);
+    }
+}
+#endif
+
+/**
+ * @brief Positions searched by the search benchmark (the starting position and positions after random openings)
+ */
+const std::vector<GameState> SEARCH_BENCHMARK_POSITIONS = {
+        GameState(Board(0xfff00000, 0xfff), true),
+        GameState(Board(0xff510000, 0x6cdf), true),
+        GameState(Board(0xbfe10000, 0x845fd), true),
+        GameState(Board(0x5fd20000, 0x821fd), true),
+        GameState(Board(0xd1e30000, 0x80016db), true),
+        GameState(Board(0x11e10000, 0xb2f), true),
+        GameState(Board(0x41b581004, 0x372), true),
+        GameState(Board(0x839010008, 0x4102323), true),
+        GameState(Board(0x400000, 0x40000400421c), true)
+};
+
+/**
+ * @brief Search configurations compared by the search benchmark (changes of CURRENT_AGENT_CONFIG)
+ */
+const std::vector<std::pair<std::string, nlohmann::json>> SEARCH_BENCHMARK_CONFIGURATIONS = {
+        {"alpha-beta", {{USE_PVS_ID, false}, {ASPIRATION_WINDOW_ID, 0}, {USE_KILLER_MOVES_ID, false}, {USE_HISTORY_HEURISTIC_ID, false}, {USE_LATE_MOVE_REDUCTIONS_ID, false}}},
+        {"PVS", {{USE_PVS_ID, true}, {ASPIRATION_WINDOW_ID, 0}, {USE_KILLER_MOVES_ID, false}, {USE_HISTORY_HEURISTIC_ID, false}, {USE_LATE_MOVE_REDUCTIONS_ID, false}}},
+        {"aspiration", {{USE_PVS_ID, false}, {ASPIRATION_WINDOW_ID, 100}, {USE_KILLER_MOVES_ID, false}, {USE_HISTORY_HEURISTIC_ID, false}, {USE_LATE_MOVE_REDUCTIONS_ID, false}}},
+        {"killers + history", {{USE_PVS_ID, false}, {ASPIRATION_WINDOW_ID, 0}, {USE_KILLER_MOVES_ID, true}, {USE_HISTORY_HEURISTIC_ID, true}, {USE_LATE_MOVE_REDUCTIONS_ID, false}}},
+        {"killers + history + PVS", {{USE_PVS_ID, true}, {ASPIRATION_WINDOW_ID, 0}, {USE_KILLER_MOVES_ID, true}, {USE_HISTORY_HEURISTIC_ID, true}, {USE_LATE_MOVE_REDUCTIONS_ID, false}}},
+        {"killers + history + LMR", {{USE_PVS_ID, false}, {ASPIRATION_WINDOW_ID, 0}, {USE_KILLER_MOVES_ID, true}, {USE_HISTORY_HEURISTIC_ID, true}, {USE_LATE_MOVE_REDUCTIONS_ID, true}}},
+        {"killers + history + PVS + LMR", {{USE_PVS_ID, true}, {ASPIRATION_WINDOW_ID, 0}, {USE_KILLER_MOVES_ID, true}, {USE_HISTORY_HEURISTIC_ID, true}, {USE_LATE_MOVE_REDUCTIONS_ID, true}}}
+};
+
+/**
+ * @brief Searches every benchmark position with iterative deepening up to the given depth and sums the statistics per depth
+ * @tparam Search The iterative deepening search (IterativeMinimax or MtdfMinimax)
+ * @param configuration The changes of the default configuration
+ * @param maxDepth The maximum depth
+ * @return The summed statistics of each depth (index = depth - 1)
+ */
+template<typename Search = IterativeMinimax>
+std::vector<SearchStatistics> benchmarkSearch(const nlohmann::json &configuration, int maxDepth) {
+    nlohmann::json data = nlohmann::json::parse(CURRENT_AGENT_CONFIG);
+    data.merge_patch(configuration);
+    data[MAX_DEPTH_ID] = maxDepth;
+    data[MOVE_TIME_LIMIT_ID] = 1000000000; // The search is never interrupted
+    Hyperparameters hyperparameters(data.dump());
+    AdvancedEvaluation evaluation(hyperparameters);
+    auto search = std::make_unique<Search>(hyperparameters, evaluation); // Heap allocated because of the cache
+
+    std::vector<SearchStatistics> results(maxDepth);
+    for (const GameState &position : SEARCH_BENCHMARK_POSITIONS) {
+        Game game(position);
+        Timer timer(4000000000);
+        search->findBestMove(game, timer);
+
+        const std::vector<SearchStatistics> &iterations = search->getIterationStatistics();
+        for (size_t i = 0; i < iterations.size(); i++) {
+            results[i].nodes += iterations[i].nodes;
+            results[i].quiescenceNodes += iterations[i].quiescenceNodes;
+            results[i].researches += iterations[i].researches;
+            results[i].cutoffs += iterations[i].cutoffs;
+            results[i].firstMoveCutoffs += iterations[i].firstMoveCutoffs;
+            results[i].reductions += iterations[i].reductions;
+            results[i].reductionResearches += iterations[i].reductionResearches;
+            results[i].probCuts += iterations[i].probCuts;
+            results[i].razorCuts += iterations[i].razorCuts;
+            results[i].futilityPrunes += iterations[i].futilityPrunes;
+            results[i].boundCutoffs += iterations[i].boundCutoffs;
+            results[i].probes += iterations[i].probes;
+            results[i].aspirationFails += iterations[i].aspirationFails;
+            results[i].milliseconds += iterations[i].milliseconds;
+        }
+    }
+    return results;
+}
+
+bool killerMovesTest() {
+    message("Running killer moves test", true);
+    nlohmann::json data = nlohmann::json::parse(CURRENT_AGENT_CONFIG);
+    data[USE_KILLER_MOVES_ID] = true;
+    Hyperparameters hyperparameters(data.dump());
+    AdvancedEvaluation evaluation(hyperparameters);
+    auto search = std::make_unique<Minimax>(hyperparameters, evaluation);
+
+    bool passed = true;
+    for (const GameState &position : SEARCH_BENCHMARK_POSITIONS) {
+        Game game(position);
+        if (game.getGameState().hasCapture()) // Only quiet moves are killer moves
+            continue;
+        const MoveList moves = game.getGameState().getAvailableMoves();
+        for (int ply = 0; ply < 4; ply++) {
+            // Every move beats a loss, so the first move searched cuts off
+            search->prepareSearch();
+            Timer timer(4000000000);
+            search->searchNode(game, timer, ply, 1, LOSS_SCORE, LOSS_SCORE + 1);
+
+            const piece_move killer = search->getKillerMoves(ply)[0];
+            bool stored = std::find(moves.begin(), moves.end(), killer) != moves.end();
+            for (int otherPly = 0; otherPly < MAX_SEARCH_PLY; otherPly++)
+                stored &= otherPly == ply || search->getKillerMoves(otherPly)[0] == 0;
+            if (!stored) {
+                message(std::format("cutoff at ply {} not stored as its killer move", ply));
+                std::cout << game.getGameState() << std::flush;
+            }
+            passed &= stored;
+        }
+    }
+    message(passed ? "OK" : "FAILED");
+    return passed;
+}
+
+void searchPerformanceTest(int maxDepth) {
+    message("Running search benchmark (nodes per depth summed over the position suite, relative to the first configuration)", true);
+    std::vector<std::vector<SearchStatistics>> results;
+    for (const auto &[name, configuration] : SEARCH_BENCHMARK_CONFIGURATIONS)
+        results.push_back(benchmarkSearch(configuration, maxDepth));
+
+    for (int depth = 1; depth <= maxDepth; depth++) {
+        std::string line = std::format("depth {}", depth);
+        uint64_t baseNodes = 0;
+        for (size_t i = 0; i < results.size(); i++) {
+            const SearchStatistics &statistics = results[i][depth - 1];
+            uint64_t nodes = statistics.nodes + statistics.quiescenceNodes;
+            if (i == 0)
+                baseNodes = std::max(nodes, uint64_t(1));
+            double firstMoveCutoffRate = static_cast<double>(statistics.firstMoveCutoffs) / static_cast<double>(std::max(statistics.cutoffs, uint64_t(1)));
+            line += std::format("{} {} {} nodes [{}ms, {:.2f}x, {:.0f}% first-move cutoffs]", i == 0 ? ":" : " |", SEARCH_BENCHMARK_CONFIGURATIONS[i].first, nodes,
+                                statistics.milliseconds, static_cast<double>(nodes) / static_cast<double>(baseNodes), 100 * firstMoveCutoffRate);
+        }
+        message(line);
+    }
+}
+
+/**
+ * @brief Forward pruning configurations compared by the pruning benchmark (changes of CURRENT_AGENT_CONFIG)
+ */
+const std::vector<std::pair<std::string, nlohmann::json>> PRUNING_BENCHMARK_CONFIGURATIONS = {
+        {"no pruning", {{USE_PROBCUT_ID, false}, {USE_RAZORING_ID, false}, {USE_FUTILITY_PRUNING_ID, false}}},
+        {"ProbCut", {{USE_PROBCUT_ID, true}, {USE_RAZORING_ID, false}, {USE_FUTILITY_PRUNING_ID, false}}},
+        {"razoring", {{USE_PROBCUT_ID, false}, {USE_RAZORING_ID, true}, {USE_FUTILITY_PRUNING_ID, false}}},
+        {"futility", {{USE_PROBCUT_ID, false}, {USE_RAZORING_ID, false}, {USE_FUTILITY_PRUNING_ID, true}}},
+        {"all", {{USE_PROBCUT_ID, true}, {USE_RAZORING_ID, true}, {USE_FUTILITY_PRUNING_ID, true}}}
+};
+
+void forwardPruningPerformanceTest(int maxDepth) {
+    message(std::format("Running forward pruning benchmark (nodes of depth {} summed over the position suite, relative to no pruning)", maxDepth), true);
+    uint64_t baseNodes = 0;
+    for (const auto &[name, configuration] : PRUNING_BENCHMARK_CONFIGURATIONS) {
+        const SearchStatistics statistics = benchmarkSearch(configuration, maxDepth)[maxDepth - 1];
+        uint64_t nodes = statistics.nodes + statistics.quiescenceNodes;
+        if (baseNodes == 0)
+            baseNodes = std::max(nodes, uint64_t(1));
+        message(std::format("{}: {} nodes [{}ms, {:.2f}x], {} ProbCuts, {} razor cuts, {} futility prunes", name, nodes, statistics.milliseconds,
+                            static_cast<double>(nodes) / static_cast<double>(baseNodes), statistics.probCuts, statistics.razorCuts, statistics.futilityPrunes));
+    }
+}
+
+void mtdfPerformanceTest(int maxDepth) {
+    message("Running MTD(f) benchmark (nodes per depth summed over the position suite, relative to IterativeMinimax)", true);
+    const nlohmann::json boundCutoffs = {{USE_BOUND_CUTOFFS_ID, true}};
+    const std::vector<std::pair<std::string, std::vector<SearchStatistics>>> results = {
+            {"IterativeMinimax", benchmarkSearch<IterativeMinimax>(nlohmann::json::object(), maxDepth)},
+            {"IterativeMinimax + bound cutoffs", benchmarkSearch<IterativeMinimax>(boundCutoffs, maxDepth)},
+            {"MTD(f)", benchmarkSearch<MtdfMinimax>(nlohmann::json::object(), maxDepth)},
+            {"MTD(f) + bound cutoffs", benchmarkSearch<MtdfMinimax>(boundCutoffs, maxDepth)}
+    };
+
+    for (int depth = 1; depth <= maxDepth; depth++) {
+        std::string line = std::format("depth {}", depth);
+        uint64_t baseNodes = 0;
+        for (size_t i = 0; i < results.size(); i++) {
+            const SearchStatistics &statistics = results[i].second[depth - 1];
+            uint64_t nodes = statistics.nodes + statistics.quiescenceNodes;
+            if (i == 0)
+                baseNodes = std::max(nodes, uint64_t(1));
+            line += std::format("{} {} {} nodes [{}ms, {:.2f}x, {} probes]", i == 0 ? ":" : " |", results[i].first, nodes,
+                                statistics.milliseconds, static_cast<double>(nodes) / static_cast<double>(baseNodes), statistics.probes);
+        }
+        message(line);
+    }
+}
+
+/**
+ * @brief Numbers of nodes between two reads of the clock compared by the time check benchmark
+ */
+const std::vector<int> TIME_CHECK_BENCHMARK_INTERVALS = {1, 64, 1024, 16384};
+
+void timeCheckPerformanceTest(long long moveTimeLimit) {
+    message(std::format("Running time check benchmark (searches of the position suite limited to {}ms per move)", moveTimeLimit), true);
+    for (int interval : TIME_CHECK_BENCHMARK_INTERVALS) {
+        nlohmann::json data = nlohmann::json::parse(CURRENT_AGENT_CONFIG);
+        data[TIME_CHECK_INTERVAL_ID] = interval;
+        data[MOVE_TIME_LIMIT_ID] = moveTimeLimit;
+        data[MAX_DEPTH_ID] = 100;
+        Hyperparameters hyperparameters(data.dump());
+        AdvancedEvaluation evaluation(hyperparameters);
+        auto search = std::make_unique<IterativeMinimax>(hyperparameters, evaluation); // Heap allocated because of the cache
+
+        uint64_t nodes = 0;
+        long long totalMicroseconds = 0;
+        long long totalOvershoot = 0;
+        long long maxOvershoot = 0;
+        int interrupted = 0;
+        for (const GameState &position : SEARCH_BENCHMARK_POSITIONS) {
+            Game game(position);
+            Timer timer(4000000000);
+            auto begin = std::chrono::steady_clock::now();
+            search->findBestMove(game, timer);
+            long long microseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+            totalMicroseconds += microseconds;
+            if (microseconds >= moveTimeLimit * 1000) { // Stopped by the timer (the other searches ended early with a decided game)
+                interrupted++;
+                totalOvershoot += microseconds - moveTimeLimit * 1000;
+                maxOvershoot = std::max(maxOvershoot, microseconds - moveTimeLimit * 1000);
+            }
+            for (const SearchStatistics &statistics : search->getIterationStatistics())
+                nodes += statistics.nodes + statistics.quiescenceNodes;
+        }
+        message(std::format("clock read every {} nodes: {:.0f} nodes/s, overshoot of {} interrupted searches mean {}us, max {}us", interval,
+                            static_cast<double>(nodes) * 1e6 / static_cast<double>(std::max(totalMicroseconds, 1ll)), interrupted,
+                            totalOvershoot / std::max(interrupted, 1), maxOvershoot));
+    }
+}
+
+/**
+ * @brief Thread counts compared by the parallel search benchmark
+ */
+const std::vector<int> PARALLEL_BENCHMARK_THREADS = {1, 2, 4, 8, 16};
+
+/**
+ * @brief Measures the time the given search needs to search every benchmark position to the given depth
+ * @tparam Search The search algorithm (IterativeMinimax or ParallelMinimax)
+ * @param threads The number of search threads
+ * @param maxDepth The searched depth
+ * @param onSearched Called with the search after each position (collects statistics)
+ * @return The total duration in milliseconds
+ */
+template<class Search, class Callback>
+long long timeParallelSearch(int threads, int maxDepth, Callback onSearched) {
+    nlohmann::json data = nlohmann::json::parse(CURRENT_AGENT_CONFIG);
+    data[THREADS_ID] = threads;
+    data[MAX_DEPTH_ID] = maxDepth;
+    data[MOVE_TIME_LIMIT_ID] = 1000000000; // The search is never interrupted
+    Hyperparameters hyperparameters(data.dump());
+    AdvancedEvaluation evaluation(hyperparameters);
+    auto search = std::make_unique<Search>(hyperparameters, evaluation); // Heap allocated because of the cache
+
+    long long milliseconds = 0;
+    for (const GameState &position : SEARCH_BENCHMARK_POSITIONS) {
+        Game game(position);
+        Timer timer(4000000000);
+        auto begin = std::chrono::steady_clock::now();
+        search->findBestMove(game, timer);
+        milliseconds += std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count();
+        onSearched(*search);
+    }
+    return milliseconds;
+}
+
+void parallelSearchPerformanceTest(int maxDepth) {
+    message(std::format("Running parallel search benchmark (time to depth {} on the position suite, speedup relative to 1 thread of IterativeMinimax)", maxDepth), true);
+    message(std::format("Hardware threads: {}", std::thread::hardware_concurrency()));
+    long long baseMilliseconds = 0;
+    for (int threads : PARALLEL_BENCHMARK_THREADS) {
+        long long lazyMilliseconds = timeParallelSearch<IterativeMinimax>(threads, maxDepth, [](const IterativeMinimax &) {});
+        ParallelSearchStatistics statistics;
+        long long parallelMilliseconds = timeParallelSearch<ParallelMinimax>(threads, maxDepth, [&statistics](const ParallelMinimax &search) {
+            statistics.nodes += search.getStatistics().nodes;
+            statistics.splits += search.getStatistics().splits;
+            statistics.steals += search.getStatistics().steals;
+        });
+        if (threads == 1)
+            baseMilliseconds = std::max(lazyMilliseconds, 1ll);
+        message(std::format("{} threads: IterativeMinimax (Lazy SMP) {}ms [{:.2f}x] | ParallelMinimax (YBWC) {}ms [{:.2f}x, {} nodes, {} splits, {} steals]",
+                            threads, lazyMilliseconds, static_cast<double>(baseMilliseconds) / static_cast<double>(std::max(lazyMilliseconds, 1ll)),
+                            parallelMilliseconds, static_cast<double>(baseMilliseconds) / static_cast<double>(std::max(parallelMilliseconds, 1ll)),
+                            statistics.nodes, statistics.splits, statistics.steals));
+    }
+}
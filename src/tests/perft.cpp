@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "includes/perft.hpp"
+#include "../communication/includes/board_key.hpp"
+
+double PerftResult::nodesPerSecond() const {
+    return static_cast<double>(nodes) * 1000.0 / static_cast<double>(std::max(milliseconds, 1ll));
+}
+
+PerftTable::PerftTable(size_t megabytes) {
+    size_t entryCount = 1;
+    while (entryCount * 2 * sizeof(Entry) <= megabytes * 1024 * 1024)
+        entryCount *= 2;
+    entries = std::vector<Entry>(entryCount);
+}
+
+uint64_t PerftTable::getKey(zobrist_key hash, int depth) {
+    return hash ^ static_cast<uint64_t>(depth) * 0x9e3779b97f4a7c15;
+}
+
+std::optional<uint64_t> PerftTable::probe(const Game &game, int depth) {
+    probes.fetch_add(1, std::memory_order_relaxed);
+    uint64_t key = getKey(game.getHash(), depth);
+    Entry &entry = entries[key & (entries.size() - 1)];
+    uint64_t nodes = entry.nodes.load(std::memory_order_relaxed);
+    if ((entry.check.load(std::memory_order_relaxed) ^ nodes) != (key | 1)) // The checked key is never 0, so that empty entries do not match
+        return std::nullopt;
+    hits.fetch_add(1, std::memory_order_relaxed);
+    return nodes;
+}
+
+void PerftTable::store(const Game &game, int depth, uint64_t nodes) {
+    uint64_t key = getKey(game.getHash(), depth);
+    Entry &entry = entries[key & (entries.size() - 1)];
+    entry.check.store((key | 1) ^ nodes, std::memory_order_relaxed);
+    entry.nodes.store(nodes, std::memory_order_relaxed);
+}
+
+uint64_t PerftTable::getProbes() const {
+    return probes.load();
+}
+
+uint64_t PerftTable::getHits() const {
+    return hits.load();
+}
+
+double PerftTable::hitRate() const {
+    return static_cast<double>(getHits()) / static_cast<double>(std::max(getProbes(), uint64_t(1)));
+}
+
+size_t PerftTable::size() const {
+    return entries.size();
+}
+
+/**
+ * @brief Plays a generated move through the trusted path or, if requested, through the validated one (to measure the validation overhead)
+ */
+inline void playMove(Game &game, piece_move move, const PerftOptions &options){
+    if (options.validateMoves)
+        game.makeMove(move);
+    else
+        game.makeMoveUnchecked(move);
+}
+
+/**
+ * @brief Counts the leaf nodes of the game tree.
+ *
+ * Positions one move above the leaves are not expanded, the size of their move list is counted instead (bulk counting).
+ * If a table is given, counts of subtrees of depth 2 and more are stored in it and reused for transpositions.
+ * @param game The game whose current state is the root of the tree
+ * @param depth The depth of the tree
+ * @param options The table of already counted subtrees (optional) and whether to validate the played moves
+ * @return The number of leaf nodes
+ */
+uint64_t perft(Game &game, int depth, const PerftOptions &options){
+    if (depth < 1)
+        return 1;
+    const GameState &gameState = game.getGameState();
+    if (depth == 1)
+        return gameState.getAvailableMoves().size();
+
+    if (options.table) {
+        if (std::optional<uint64_t> nodes = options.table->probe(game, depth))
+            return *nodes;
+    }
+
+    MoveList possibleMoves = gameState.getAvailableMoves(); // Copy, the game state view is rebuilt after every move
+    uint64_t counter = 0;
+    for (const piece_move move : possibleMoves) {
+        playMove(game, move, options);
+        counter += perft(game, depth - 1, options);
+        game.undoMove();
+    }
+
+    if (options.table)
+        options.table->store(game, depth, counter);
+    return counter;
+}
+
+/**
+ * @brief Counts the leaf nodes below each root move using multiple threads.
+ *
+ * The tree is split into subtrees below every pair of a root move and a second-ply move.
+ * The subtrees are dealt to per-thread queues, each thread takes work from the front of its own queue and,
+ * once it is empty, steals from the back of the queues of the other threads.
+ * The totals are the same as those of the single-threaded perft.
+ * @param game The game whose current state is the root of the tree
+ * @param depth The depth of the tree (at least 2)
+ * @param options The number of threads, the table of already counted subtrees shared by the threads (optional) and whether to validate the played moves
+ * @return The leaf count of each root move (in the order of the available moves)
+ */
+std::vector<uint64_t> parallelRootCounts(Game &game, int depth, const PerftOptions &options){
+    const unsigned int threads = options.threads;
+    MoveList rootMoves = game.getGameState().getAvailableMoves();
+    std::vector<std::atomic<uint64_t>> rootCounts(rootMoves.size());
+
+    std::vector<std::deque<PerftTask>> queues(threads);
+    std::vector<std::mutex> queueMutexes(threads);
+    unsigned int taskCount = 0;
+    for (unsigned int i = 0; i < rootMoves.size(); i++) {
+        playMove(game, rootMoves[i], options);
+        for (const piece_move secondMove : game.getGameState().getAvailableMoves())
+            queues[taskCount++ % threads].push_back({i, rootMoves[i], secondMove});
+        game.undoMove();
+    }
+
+    auto takeTask = [&](unsigned int thread) -> std::optional<PerftTask> {
+        {
+            std::lock_guard<std::mutex> lock(queueMutexes[thread]);
+            if (!queues[thread].empty()) {
+                PerftTask task = queues[thread].front();
+                queues[thread].pop_front();
+                return task;
+            }
+        }
+        for (unsigned int offset = 1; offset < threads; offset++) { // Steal from the others
+            unsigned int victim = (thread + offset) % threads;
+            std::lock_guard<std::mutex> lock(queueMutexes[victim]);
+            if (!queues[victim].empty()) {
+                PerftTask task = queues[victim].back();
+                queues[victim].pop_back();
+                return task;
+            }
+        }
+        return std::nullopt;
+    };
+
+    // The root state is built once here, Game::getGameState fills a cache and must not be called by the threads concurrently
+    const GameState rootState = game.getGameState();
+    auto work = [&](unsigned int thread) {
+        Game localGame(rootState);
+        while (std::optional<PerftTask> task = takeTask(thread)) {
+            playMove(localGame, task->rootMove, options);
+            playMove(localGame, task->secondMove, options);
+            rootCounts[task->rootIndex] += perft(localGame, depth - 2, options);
+            localGame.undoMove();
+            localGame.undoMove();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned int thread = 1; thread < threads; thread++)
+        workers.emplace_back(work, thread);
+    work(0);
+    for (std::thread &worker : workers)
+        worker.join();
+
+    return {rootCounts.begin(), rootCounts.end()};
+}
+
+PerftResult timedPerft(Game &game, int depth, const PerftOptions &options){
+    auto start = std::chrono::steady_clock::now();
+    uint64_t nodes = 0;
+    if (options.threads <= 1 || depth < 3) {
+        nodes = perft(game, depth, options);
+    }
+    else {
+        for (uint64_t count : parallelRootCounts(game, depth, options))
+            nodes += count;
+    }
+    auto end = std::chrono::steady_clock::now();
+    return {nodes, std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()};
+}
+
+std::vector<std::pair<piece_move, uint64_t>> divide(Game &game, int depth, const PerftOptions &options){
+    std::vector<std::pair<piece_move, uint64_t>> counts;
+    MoveList possibleMoves = game.getGameState().getAvailableMoves();
+    if (options.threads > 1 && depth >= 3) {
+        std::vector<uint64_t> rootCounts = parallelRootCounts(game, depth, options);
+        for (unsigned int i = 0; i < possibleMoves.size(); i++)
+            counts.emplace_back(possibleMoves[i], rootCounts[i]);
+        return counts;
+    }
+    for (const piece_move move : possibleMoves) {
+        playMove(game, move, options);
+        counts.emplace_back(move, perft(game, depth - 1, options));
+        game.undoMove();
+    }
+    return counts;
+}
+
+/**
+ * @brief Checks the round trip of the board keys (BoardKey::fromBoard followed by BoardKey::toBoard) on the positions of random playouts.
+ *
+ * Every position is encoded and decoded with the BMI2 bit operations (pext and pdep, if the build enables them) and with the portable loops,
+ * both keys must be equal and both must restore the board and the side to move.
+ * @param playouts The number of playouts from the starting position
+ * @param seed The seed of the random moves
+ * @return The number of checked positions and of mismatches
+ */
+BoardKeyCheck checkBoardKeys(unsigned int playouts, unsigned int seed){
+    constexpr int MAX_PLAYOUT_LENGTH = 200; // Playouts of kings can go on forever
+    std::mt19937 randomEngine(seed);
+    BoardKeyCheck result;
+    for (unsigned int playout = 0; playout < playouts; playout++) {
+        Game game(GameState(Board(0xfff00000, 0xfff), true));
+        for (int ply = 0; ply < MAX_PLAYOUT_LENGTH && !game.isFinished(); ply++) {
+            const Board board = game.getBoard();
+            const BoardKey key = BoardKey::fromBoard(board, game.isNextBlack());
+            const BoardKey portableKey = BoardKey::fromBoard<true>(board, game.isNextBlack());
+            result.positions++;
+            result.mismatches += key != portableKey || !(key.toBoard() == board) || !(portableKey.toBoard<true>() == board)
+                                 || key.isNextBlack() != game.isNextBlack();
+
+            const MoveList &moves = game.getGameState().getAvailableMoves();
+            game.makeMoveUnchecked(moves[randomEngine() % moves.size()]);
+        }
+    }
+    return result;
+}
+
+GameState getGameStateFromStream(std::istream &inputStream){
+    std::string color;
+    inputStream >> color;
+    if (color != "black" && color != "white")
+        throw std::runtime_error("Invalid side to move: " + color + " (expected black or white).");
+    Board board = getBoardFromStream(inputStream);
+    return {board, color == "black"};
+}